@@ -13,6 +13,9 @@
 
 using namespace QAccessibleClient;
 
+// Opening a connection blocks, a slot that failed is not tried again right away.
+static const int failedSlotRetryInterval = 1000;
+
 DBusConnection::DBusConnection()
     : QObject()
     , m_connection(QDBusConnection::sessionBus())
@@ -20,6 +23,12 @@ DBusConnection::DBusConnection()
     init();
 }
 
+DBusConnection::~DBusConnection()
+{
+    for (auto it = m_pool.constBegin(); it != m_pool.constEnd(); ++it)
+        QDBusConnection::disconnectFromBus(poolConnectionName(it.key()));
+}
+
 void DBusConnection::init()
 {
     QDBusConnection c = QDBusConnection::sessionBus();
@@ -39,10 +48,25 @@ void DBusConnection::init()
 
 void DBusConnection::initFinished()
 {
-    if (!m_initWatcher)
+    QMutexLocker fetchLocker(&m_fetchMutex);
+    if (!fetched())
         return;
-    m_status = ConnectionError;
-    QDBusPendingReply<QString> reply = *m_initWatcher;
+    fetchLocker.unlock();
+    Q_EMIT connectionFetched();
+}
+
+bool DBusConnection::fetched()
+{
+    QMutexLocker locker(&m_mutex);
+    QDBusPendingCallWatcher *watcher = m_initWatcher;
+    if (!watcher)
+        return false;
+    // Connecting waits for the bus, the other methods do not have to.
+    locker.unlock();
+
+    QDBusConnection connection = QDBusConnection::sessionBus();
+    QString address;
+    QDBusPendingReply<QString> reply = *watcher;
     if (reply.isError() || reply.value().isEmpty()) {
         qWarning() << "Accessibility DBus not found. Falling back to session bus.";
     } else {
@@ -51,33 +75,147 @@ void DBusConnection::initFinished()
         QDBusConnection c = QDBusConnection::connectToBus(busAddress, QStringLiteral("a11y"));
         if (c.isConnected()) {
             qDebug() << "Connected to Accessibility DBus at address=" << busAddress;
-            m_connection = c;
-            m_status = Connected;
+            connection = c;
+            address = busAddress;
         } else {
             qWarning() << "Found Accessibility DBus address=" << busAddress << "but cannot connect. Falling back to session bus.";
         }
     }
-    m_initWatcher->deleteLater();
+
+    locker.relock();
+    m_connection = connection;
+    m_address = address;
+    m_status = address.isEmpty() ? ConnectionError : Connected;
     m_initWatcher = nullptr;
-    Q_EMIT connectionFetched();
+    locker.unlock();
+    watcher->deleteLater();
+    return true;
 }
 
 bool DBusConnection::isFetchingConnection() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_initWatcher;
 }
 
 QDBusConnection DBusConnection::connection() const
 {
+    QMutexLocker locker(&m_mutex);
+    if (!m_initWatcher)
+        return m_connection;
+    locker.unlock();
+
+    // The first caller waits for the address and connects, the others wait for that.
+    QMutexLocker fetchLocker(&m_fetchMutex);
+    locker.relock();
     if (m_initWatcher) {
-        m_initWatcher->waitForFinished();
-        const_cast<DBusConnection*>(this)->initFinished();
+        // Not the watcher's waitForFinished(), that delivers finished() right away in its thread.
+        QDBusPendingCall call = *m_initWatcher;
+        locker.unlock();
+        call.waitForFinished();
+        if (const_cast<DBusConnection*>(this)->fetched()) {
+            fetchLocker.unlock();
+            Q_EMIT const_cast<DBusConnection*>(this)->connectionFetched();
+        }
+        locker.relock();
     }
     return m_connection;
 }
 
+QDBusConnection DBusConnection::connection(const QString &service) const
+{
+    // May wait for the address of the bus, call it unlocked.
+    const QDBusConnection primary = connection();
+    QMutexLocker locker(&m_mutex);
+    if (m_poolSize < 2 || service.isEmpty())
+        return primary;
+    // Kept when the pool grows, calls to a service are not reordered.
+    auto assignment = m_services.find(service);
+    if (assignment == m_services.end())
+        assignment = m_services.insert(service, int(qHash(service) % uint(m_poolSize)));
+    const int index = assignment.value();
+    if (index == 0)
+        return primary;
+
+    const auto it = m_pool.constFind(index);
+    if (it != m_pool.constEnd())
+        return it.value();
+    const auto failed = m_failedSlots.constFind(index);
+    if (failed != m_failedSlots.constEnd() && !failed.value().hasExpired())
+        return primary;
+    const QString address = m_address;
+    locker.unlock();
+
+    // Opening a connection waits for the bus, calls to other services go on meanwhile.
+    const QString name = poolConnectionName(index);
+    QDBusConnection c = address.isEmpty()
+            ? QDBusConnection::connectToBus(QDBusConnection::SessionBus, name)
+            : QDBusConnection::connectToBus(address, name);
+    locker.relock();
+    if (!c.isConnected()) {
+        qWarning() << "Could not open pooled connection" << index << c.lastError().message();
+        QDBusConnection::disconnectFromBus(name);
+        // Tried again after a while, until then the services of this slot share the main connection.
+        m_failedSlots.insert(index, QDeadlineTimer(failedSlotRetryInterval));
+        return primary;
+    }
+    if (index >= m_poolSize) {
+        // The pool shrank in the meantime.
+        QDBusConnection::disconnectFromBus(name);
+        return primary;
+    }
+    m_failedSlots.remove(index);
+    m_pool.insert(index, c);
+    return c;
+}
+
+void DBusConnection::releaseService(const QString &service)
+{
+    QMutexLocker locker(&m_mutex);
+    m_services.remove(service);
+}
+
+void DBusConnection::setPoolSize(int size)
+{
+    QMutexLocker locker(&m_mutex);
+    m_poolSize = qMax(1, size);
+    for (auto it = m_pool.begin(); it != m_pool.end(); ) {
+        if (it.key() < m_poolSize) {
+            ++it;
+            continue;
+        }
+        QDBusConnection::disconnectFromBus(poolConnectionName(it.key()));
+        it = m_pool.erase(it);
+    }
+    // The services of closed connections are spread over the remaining ones.
+    for (auto it = m_services.begin(); it != m_services.end(); ) {
+        if (it.value() < m_poolSize)
+            ++it;
+        else
+            it = m_services.erase(it);
+    }
+    for (auto it = m_failedSlots.begin(); it != m_failedSlots.end(); ) {
+        if (it.key() < m_poolSize)
+            ++it;
+        else
+            it = m_failedSlots.erase(it);
+    }
+}
+
+int DBusConnection::poolSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_poolSize;
+}
+
+QString DBusConnection::poolConnectionName(int index) const
+{
+    return QStringLiteral("qaccessibilityclient-pool-%1-%2").arg(quintptr(this)).arg(index);
+}
+
 DBusConnection::Status DBusConnection::status() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_status;
 }
 
@@ -10,15 +10,22 @@
 #include <QObject>
 #include <QDBusConnection>
 #include <QDBusPendingCallWatcher>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutex>
+
+#include "qaccessibilityclient_export.h"
 
 namespace QAccessibleClient {
 
 
 /**
     Connection to the a11y dbus bus.
+
+    The methods can be called from any thread. Exported for the unit tests only.
     \internal
  */
-class DBusConnection : public QObject
+class QACCESSIBILITYCLIENT_EXPORT DBusConnection : public QObject
 {
     Q_OBJECT
 public:
@@ -31,6 +38,7 @@ public:
         block till the connection was fetched and is ready for use.
      */
     DBusConnection();
+    ~DBusConnection() override;
 
     /**
         \brief Returns true if the \a connection is not ready yet.
@@ -56,6 +64,34 @@ public:
      */
     QDBusConnection connection() const;
 
+    /**
+        \brief Returns the connection the calls to \a service go through.
+
+        With a pool size above 1 the services are spread over that many
+        connections to the same bus, so that blocking calls to different
+        applications do not queue up behind each other. A service always
+        gets the same connection, also when the pool grows. The first one
+        is \a connection itself, the others are opened when first needed.
+        While one cannot be opened its services use \a connection, it is
+        tried again a second later.
+     */
+    QDBusConnection connection(const QString &service) const;
+
+    /**
+        \brief Forgets the connection of \a service, which left the bus.
+     */
+    void releaseService(const QString &service);
+
+    /**
+        \brief Sets the number of connections calls are spread over.
+
+        Connections beyond \a size are closed, calls still waiting on
+        them fail and their services get one of the remaining connections.
+        Defaults to 1, all calls go through \a connection.
+     */
+    void setPoolSize(int size);
+    int poolSize() const;
+
     enum Status {
         Disconnected,
         ConnectionError,
@@ -92,10 +128,26 @@ private Q_SLOTS:
 
 private:
     void init();
-
+    // Takes the reply to GetAddress, returns false if that happened before. Expects m_fetchMutex to be locked.
+    bool fetched();
+    QString poolConnectionName(int index) const;
+
+    // Guards the members, never held while waiting for the bus.
+    mutable QMutex m_mutex;
+    // Held while taking the reply to GetAddress and connecting, before m_mutex.
+    mutable QMutex m_fetchMutex;
     QDBusConnection m_connection;
     mutable Status m_status = Disconnected;
     QDBusPendingCallWatcher *m_initWatcher = nullptr;
+    // Address of the accessibility bus, empty when using the session bus.
+    QString m_address;
+    int m_poolSize = 1;
+    // Opened pool connections by index, index 0 is m_connection.
+    mutable QHash<int, QDBusConnection> m_pool;
+    // Pool index of every service that got a connection.
+    mutable QHash<QString, int> m_services;
+    // Indexes that could not be opened, by when to try again.
+    mutable QHash<int, QDeadlineTimer> m_failedSlots;
 };
 }
 
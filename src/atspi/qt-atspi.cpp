@@ -65,6 +65,52 @@ const QDBusArgument &operator>>(const QDBusArgument &argument, QAccessibleClient
     return argument;
 }
 
+/* QSpiAccessibleCacheItem */
+/*---------------------------------------------------------------------------*/
+
+void readCacheItem(const QDBusArgument &argument, bool legacy, QSpiAccessibleCacheItem &item)
+{
+    argument.beginStructure();
+    argument >> item.object;
+    argument >> item.application;
+    argument >> item.parent;
+    if (legacy) {
+        argument >> item.children;
+        item.indexInParent = -1;
+        item.childCount = item.children.count();
+    } else {
+        argument >> item.indexInParent;
+        argument >> item.childCount;
+    }
+    argument >> item.supportedInterfaces;
+    argument >> item.name;
+    argument >> item.role;
+    argument >> item.description;
+    argument >> item.state;
+    argument.endStructure();
+}
+
+bool readCacheItems(const QDBusMessage &reply, QSpiAccessibleCacheArray &items)
+{
+    bool legacy;
+    if (reply.signature() == QLatin1String("a" QSPI_CACHE_ITEM_SIGNATURE))
+        legacy = false;
+    else if (reply.signature() == QLatin1String("a" QSPI_CACHE_ITEM_SIGNATURE_LEGACY))
+        legacy = true;
+    else
+        return false;
+
+    const QDBusArgument argument = reply.arguments().at(0).value<QDBusArgument>();
+    argument.beginArray();
+    while (!argument.atEnd()) {
+        QSpiAccessibleCacheItem item;
+        readCacheItem(argument, legacy, item);
+        items.append(item);
+    }
+    argument.endArray();
+    return true;
+}
+
 }
 QDebug operator<<(QDebug d, const QAccessibleClient::QSpiAction &t)
 {
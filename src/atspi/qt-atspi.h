@@ -8,10 +8,15 @@
 #define QT_ATSPI_H
 #define QSPI_OBJECT_PATH_ACCESSIBLE  "/org/a11y/atspi/accessible"
 #define QSPI_OBJECT_PATH_ACCESSIBLE_NULL  QSPI_OBJECT_PATH_ACCESSIBLE"/null"
+#define QSPI_CACHE_ITEM_SIGNATURE "((so)(so)(so)iiassusau)"
+#define QSPI_CACHE_ITEM_SIGNATURE_LEGACY "((so)(so)(so)a(so)assusau)"
 
 #include <QList>
 #include <QString>
+#include <QStringList>
+#include <QVector>
 #include <QDBusArgument>
+#include <QDBusMessage>
 #include <QDebug>
 
 namespace QAccessibleClient {
@@ -43,6 +48,28 @@ struct QSpiAction
 
 typedef QList <QSpiAction> QSpiActionArray;
 
+/**
+    One object as reported by the org.a11y.atspi.Cache interface.
+    \internal
+ */
+struct QSpiAccessibleCacheItem
+{
+    QSpiObjectReference object;
+    QSpiObjectReference application;
+    QSpiObjectReference parent;
+    int indexInParent = -1;
+    int childCount = -1;
+    // only sent in the legacy layout
+    QSpiObjectReferenceList children;
+    QStringList supportedInterfaces;
+    QString name;
+    uint role = 0;
+    QString description;
+    QVector<quint32> state;
+};
+
+typedef QList<QSpiAccessibleCacheItem> QSpiAccessibleCacheArray;
+
 /**
     \internal
  */
@@ -63,6 +90,22 @@ QDBusArgument &operator<<(QDBusArgument &argument, const QSpiAction &address);
  */
 const QDBusArgument &operator>>(const QDBusArgument &argument, QSpiAction &address);
 
+/**
+    Reads one cache item. Toolkits either send the current layout
+    ((so)(so)(so)iiassusau) or the older one that lists the children
+    instead of the index in parent and child count, \a legacy selects
+    the latter.
+    \internal
+ */
+void readCacheItem(const QDBusArgument &argument, bool legacy, QSpiAccessibleCacheItem &item);
+
+/**
+    Reads the items of a GetItems reply into \a items.
+    Returns false if the reply has an unknown signature.
+    \internal
+ */
+bool readCacheItems(const QDBusMessage &reply, QSpiAccessibleCacheArray &items);
+
 }
 
 Q_DECLARE_METATYPE(QAccessibleClient::QSpiObjectReference);
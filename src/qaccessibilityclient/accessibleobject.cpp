@@ -9,6 +9,7 @@
 
 #include <QString>
 #include <QDebug>
+#include <QThread>
 
 #include "accessibleobject_p.h"
 #include "registry_p.h"
@@ -22,22 +23,40 @@ AccessibleObject::AccessibleObject()
 {
 }
 
-AccessibleObject::AccessibleObject(RegistryPrivate *registryPrivate, const QString &service, const QString &path)
-    :d(nullptr)
+// Expects the registry lock to be held, two threads creating the same object get the same private.
+static QSharedPointer<AccessibleObjectPrivate> objectPrivate(RegistryPrivate *registryPrivate, quint64 handle)
 {
-    Q_ASSERT(registryPrivate);
-    Q_ASSERT(!service.isEmpty());
-    Q_ASSERT(!path.isEmpty());
+    Q_ASSERT(handle);
+    QSharedPointer<AccessibleObjectPrivate> d;
     if (registryPrivate->m_cache) {
-        const QString id = path + service;
-        d = registryPrivate->m_cache->get(id);
+        d = registryPrivate->cache()->get(handle);
         if (!d) {
-            d = QSharedPointer<AccessibleObjectPrivate>(new AccessibleObjectPrivate(registryPrivate, service, path));
-            registryPrivate->m_cache->add(id, d);
+            d = QSharedPointer<AccessibleObjectPrivate>(new AccessibleObjectPrivate(registryPrivate, handle,
+                    registryPrivate->m_handles.service(handle), registryPrivate->m_handles.path(handle)));
+            registryPrivate->cache()->add(handle, d);
         }
     } else {
-        d = QSharedPointer<AccessibleObjectPrivate>(new AccessibleObjectPrivate(registryPrivate, service, path));
+        d = QSharedPointer<AccessibleObjectPrivate>(new AccessibleObjectPrivate(registryPrivate, handle,
+                registryPrivate->m_handles.service(handle), registryPrivate->m_handles.path(handle)));
     }
+    return d;
+}
+
+AccessibleObject::AccessibleObject(RegistryPrivate *registryPrivate, const QString &service, const QString &path)
+    :d(nullptr)
+{
+    Q_ASSERT(!service.isEmpty());
+    Q_ASSERT(!path.isEmpty());
+    // Interned under the same lock, the handle could be reclaimed in between otherwise.
+    QMutexLocker locker(&registryPrivate->m_lock);
+    d = objectPrivate(registryPrivate, registryPrivate->m_handles.handle(service, path));
+}
+
+AccessibleObject::AccessibleObject(RegistryPrivate *registryPrivate, quint64 handle)
+    :d(nullptr)
+{
+    QMutexLocker locker(&registryPrivate->m_lock);
+    d = objectPrivate(registryPrivate, handle);
 }
 
 AccessibleObject::AccessibleObject(const QSharedPointer<AccessibleObjectPrivate> &dd)
@@ -58,7 +77,16 @@ QString AccessibleObject::id() const
 {
     if (!d || !d->registryPrivate)
         return QString();
-    return d->path + d->service;
+    // Built on first use, objects are shared between threads.
+    std::call_once(d->idOnce, [this]() {
+        d->id = d->path + d->service;
+    });
+    return d->id;
+}
+
+quint64 AccessibleObject::handle() const
+{
+    return d ? d->handle : 0;
 }
 
 QUrl AccessibleObject::url() const
@@ -199,6 +227,51 @@ AccessibleObject::Interfaces AccessibleObject::supportedInterfaces() const
     return d->registryPrivate->supportedInterfaces(*this);
 }
 
+AccessibleObjectInfo AccessibleObject::info() const
+{
+    return d->registryPrivate->info(*this);
+}
+
+QFuture<QString> AccessibleObject::nameAsync() const
+{
+    return d->registryPrivate->nameAsync(*this);
+}
+
+QFuture<QString> AccessibleObject::descriptionAsync() const
+{
+    return d->registryPrivate->descriptionAsync(*this);
+}
+
+QFuture<AccessibleObject::Role> AccessibleObject::roleAsync() const
+{
+    return d->registryPrivate->roleAsync(*this);
+}
+
+QFuture<int> AccessibleObject::childCountAsync() const
+{
+    return d->registryPrivate->childCountAsync(*this);
+}
+
+QFuture<AccessibleObject> AccessibleObject::parentAsync() const
+{
+    return d->registryPrivate->parentAccessibleAsync(*this);
+}
+
+QFuture<QList<AccessibleObject> > AccessibleObject::childrenAsync() const
+{
+    return d->registryPrivate->childrenAsync(*this);
+}
+
+QFuture<QRect> AccessibleObject::boundingRectAsync() const
+{
+    return d->registryPrivate->boundingRectAsync(*this);
+}
+
+QFuture<AccessibleObject::Interfaces> AccessibleObject::supportedInterfacesAsync() const
+{
+    return d->registryPrivate->supportedInterfacesAsync(*this);
+}
+
 int AccessibleObject::caretOffset() const
 {
     if( supportedInterfaces() & AccessibleObject::TextInterface ){
@@ -398,11 +471,19 @@ QVector< QSharedPointer<QAction> > AccessibleObject::actions() const
     // Actions in atspi are supposed to be static what means they cannot change in
     // between (e.g. actions removed or added or edited) so we can safely just
     // fetch them only once and store the result for the life-time of the object,
+    // once per thread as the actions belong to the thread that asked for them.
+    {
+        QMutexLocker locker(&d->registryPrivate->m_lock);
+        if (d->actionsFetched && (d->actions.isEmpty() || d->actions.constFirst()->thread() == QThread::currentThread()))
+            return d->actions;
+    }
+    const QVector< QSharedPointer<QAction> > fetched = d->registryPrivate->actions(*this);
+    QMutexLocker locker(&d->registryPrivate->m_lock);
     if (!d->actionsFetched) {
         d->actionsFetched = true;
-        d->actions = d->registryPrivate->actions(*this);
+        d->actions = fetched;
     }
-    return d->actions;
+    return fetched;
 }
 
 bool AccessibleObject::hasSelectableText() const
@@ -507,22 +588,7 @@ bool AccessibleObject::isSingleLine() const
 
 QString AccessibleObject::stateString() const
 {
-    QStringList s;
-    if (isActive()) s << QStringLiteral("Active");
-    if (isCheckable()) s << QStringLiteral("Checkable");
-    if (isChecked()) s << QStringLiteral("Checked");
-    if (isEditable()) s << QStringLiteral("Editable");
-    if (isExpandable()) s << QStringLiteral("Expandable");
-    if (isExpanded()) s << QStringLiteral("Expanded");
-    if (isFocusable()) s << QStringLiteral("Focusable");
-    if (isFocused()) s << QStringLiteral("Focused");
-    if (isMultiLine()) s << QStringLiteral("MultiLine");
-    if (isSelectable()) s << QStringLiteral("Selectable");
-    if (isSelected()) s << QStringLiteral("Selected");
-    if (isSensitive()) s << QStringLiteral("Sensitive");
-    if (isSingleLine()) s << QStringLiteral("SingleLine");
-    if (isEnabled()) s << QStringLiteral("Enabled");
-    return s.join(QLatin1String(", "));
+    return RegistryPrivate::stateString(d->registryPrivate->state(*this), d->registryPrivate->role(*this));
 }
 
 bool AccessibleObject::isVisible() const
@@ -10,9 +10,11 @@
 
 namespace QAccessibleClient {
     class AccessibleObject;
+    struct AccessibleObjectInfo;
 }
 
 #include <QList>
+#include <QFuture>
 #include <QSharedPointer>
 #include <QAction>
 
@@ -388,6 +390,41 @@ public:
     */
     Interfaces supportedInterfaces() const;
 
+    /**
+        \name Asynchronous getters
+
+        These return immediately instead of blocking on the application.
+        Values that are cached are returned as finished futures. Use
+        QFutureWatcher (or QFuture::then() with Qt 6) to be notified once the
+        result arrived. Errors are reported the same way as by the blocking
+        getters, with the default value as result.
+
+        boundingRectAsync() does not check for the component interface first,
+        it simply yields an empty rect for accessibles that do not implement it.
+    */
+    //@{
+    QFuture<QString> nameAsync() const;
+    QFuture<QString> descriptionAsync() const;
+    QFuture<Role> roleAsync() const;
+    QFuture<int> childCountAsync() const;
+    QFuture<AccessibleObject> parentAsync() const;
+    QFuture<QList<AccessibleObject> > childrenAsync() const;
+    QFuture<QRect> boundingRectAsync() const;
+    QFuture<Interfaces> supportedInterfacesAsync() const;
+    //@}
+
+    /**
+        \brief Returns a snapshot of the values usually shown for an accessible.
+
+        All values are fetched in one go: the properties with a single
+        Properties.GetAll call and the rest with method calls that are sent
+        before waiting for the first reply. This costs about one round trip
+        instead of one per value. With a cache enabled only the values missing
+        from it are fetched and stored, so neither a second snapshot nor the
+        individual getters go to the application afterwards.
+    */
+    AccessibleObjectInfo info() const;
+
     /**
         \brief Returns the offset of the caret from the beginning of the text.
 
@@ -669,6 +706,8 @@ public:
         \brief Returns a list of actions supported by this accessible.
 
         Just trigger() the action to execute the underlying method at the accessible.
+        The actions belong to the calling thread and triggering one does not wait
+        for the application to carry it out.
     */
     QVector< QSharedPointer<QAction> > actions() const;
 
@@ -750,7 +789,10 @@ public:
 
 private:
     AccessibleObject(RegistryPrivate *reg, const QString &service, const QString &path);
+    AccessibleObject(RegistryPrivate *reg, quint64 handle);
     AccessibleObject(const QSharedPointer<AccessibleObjectPrivate> &dd);
+    // Compact id of the remote object, unique within its Registry.
+    quint64 handle() const;
     QSharedPointer<AccessibleObjectPrivate> d;
 
     friend class Registry;
@@ -761,10 +803,27 @@ private:
     friend QDebug QAccessibleClient::operator<<(QDebug, const AccessibleObject &);
 #endif
     friend uint qHash(const QAccessibleClient::AccessibleObject& object) {
-        return qHash(object.d);
+        return qHash(object.handle());
     }
 };
 
+/**
+    Values of an AccessibleObject as returned by AccessibleObject::info().
+*/
+struct AccessibleObjectInfo
+{
+    QString name;
+    QString description;
+    AccessibleObject::Role role = AccessibleObject::NoRole;
+    QString roleName;
+    QString accessibleId;
+    /// Same as AccessibleObject::stateString()
+    QString stateString;
+    AccessibleObject::Interfaces interfaces = AccessibleObject::NoInterface;
+    int childCount = 0;
+    AccessibleObject parent;
+};
+
 }
 
 Q_DECLARE_METATYPE(QAccessibleClient::AccessibleObject)
@@ -11,39 +11,87 @@
 
 using namespace QAccessibleClient;
 
-AccessibleObjectPrivate::AccessibleObjectPrivate(RegistryPrivate *reg, const QString &service_, const QString &path_)
+AccessibleObjectPrivate::AccessibleObjectPrivate(RegistryPrivate *reg, ObjectHandle handle_, const QString &service_, const QString &path_)
     : registryPrivate(reg)
+    , handle(handle_)
     , service(service_)
     , path(path_)
     , defunct(false)
     , actionsFetched(false)
+    , cachedInterfaces(AccessibleObject::InvalidInterface)
+    , cachedState(ObjectCache::StateNotFound)
+    , childrenCached(false)
+    , childrenOrdered(false)
+    , extentsEpoch(0)
+    , extentsCached(false)
+    , generation(0)
 {
     //qDebug() << Q_FUNC_INFO;
+    registryPrivate->m_handles.retain(handle);
 }
 
 AccessibleObjectPrivate::~AccessibleObjectPrivate()
 {
     //qDebug() << Q_FUNC_INFO;
 
+    QMutexLocker locker(&registryPrivate->m_lock);
     if (registryPrivate->m_cache) {
-        const QString id = path + service;
-        registryPrivate->m_cache->remove(id);
+        registryPrivate->cache()->removeDeleted(handle, this);
     }
+    clearCachedChildren();
+    registryPrivate->m_handles.release(handle);
 }
 
 bool AccessibleObjectPrivate::operator==(const AccessibleObjectPrivate &other) const
 {
     return registryPrivate == other.registryPrivate &&
-            service == other.service &&
-            path == other.path;
+            handle == other.handle;
 }
 
 void AccessibleObjectPrivate::setDefunct()
 {
     defunct = true;
 
-    for(int i = 0; i < actions.count(); ++i) {
-        const QSharedPointer<QAction> &action = actions[i];
-        action->setEnabled(false);
+    QVector< QSharedPointer<QAction> > fetchedActions;
+    {
+        QMutexLocker locker(&registryPrivate->m_lock);
+        fetchedActions = actions;
     }
+    // The actions live in the thread that asked for them.
+    for(int i = 0; i < fetchedActions.count(); ++i) {
+        const QSharedPointer<QAction> &action = fetchedActions[i];
+        QMetaObject::invokeMethod(action.data(), "setEnabled", Q_ARG(bool, false));
+    }
+}
+
+void AccessibleObjectPrivate::clearCachedData()
+{
+    cachedInterfaces = AccessibleObject::InvalidInterface;
+    cachedState = ObjectCache::StateNotFound;
+    cachedProperties.clear();
+    clearCachedChildren();
+    extentsCached = false;
+    ++generation;
+}
+
+void AccessibleObjectPrivate::setCachedChildren(const QVector<ObjectHandle> &children)
+{
+    // Retained first, the new list usually shares most handles with the old one.
+    for (ObjectHandle child : children) {
+        if (child)
+            registryPrivate->m_handles.retain(child);
+    }
+    clearCachedChildren();
+    cachedChildren = children;
+    childrenCached = true;
+}
+
+void AccessibleObjectPrivate::clearCachedChildren()
+{
+    for (ObjectHandle child : std::as_const(cachedChildren)) {
+        if (child)
+            registryPrivate->m_handles.release(child);
+    }
+    cachedChildren.clear();
+    childrenCached = false;
 }
@@ -10,6 +10,14 @@
 #include <QString>
 #include <QSharedPointer>
 #include <QAction>
+#include <QHash>
+#include <QRect>
+#include <QVariant>
+
+#include <mutex>
+
+#include "accessibleobject.h"
+#include "objecthandles_p.h"
 
 namespace QAccessibleClient {
 
@@ -18,20 +26,45 @@ class RegistryPrivate;
 class AccessibleObjectPrivate
 {
 public:
-    AccessibleObjectPrivate(RegistryPrivate *reg, const QString &service_, const QString &path_);
+    // Retains handle_ in the ObjectHandles of reg, expects the registry lock to be held.
+    AccessibleObjectPrivate(RegistryPrivate *reg, ObjectHandle handle_, const QString &service_, const QString &path_);
     ~AccessibleObjectPrivate();
 
     RegistryPrivate *registryPrivate;
+    ObjectHandle handle;
     QString service;
     QString path;
+    // built on demand by AccessibleObject::id()
+    QString id;
+    std::once_flag idOnce;
 
     bool defunct;
     mutable QVector< QSharedPointer<QAction> > actions;
     mutable bool actionsFetched;
 
+    // Filled by the ObjectCache. Living in the object itself the values
+    // can never be picked up by another object reusing the same address.
+    AccessibleObject::Interfaces cachedInterfaces;
+    quint64 cachedState;
+    QHash<int, QVariant> cachedProperties;
+    QVector<ObjectHandle> cachedChildren;
+    bool childrenCached;
+    // the children arrived in order with the events, ChildrenChanged can be applied to them
+    bool childrenOrdered;
+    QRect cachedExtents;
+    // geometry epoch of the service the extents were cached at, see extentsCached
+    quint32 extentsEpoch;
+    bool extentsCached;
+    // bumped whenever cached values are invalidated, see ObjectCache::Stamp
+    quint32 generation;
+
     bool operator==(const AccessibleObjectPrivate &other) const;
 
     void setDefunct();
+    void clearCachedData();
+    // Keep the handles of the children retained while they are cached.
+    void setCachedChildren(const QVector<ObjectHandle> &children);
+    void clearCachedChildren();
 
 private:
     Q_DISABLE_COPY(AccessibleObjectPrivate)
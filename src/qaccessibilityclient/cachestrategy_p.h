@@ -8,84 +8,625 @@
 #define QACCESSIBILITYCLIENT_CACHESTRATEGY_P_H
 
 #include "accessibleobject.h"
+#include "accessibleobject_p.h"
+#include "objecthandles_p.h"
 
+#include <QMutex>
 #include <QPair>
+#include <QRect>
+#include <QVariant>
+#include <QVector>
+
+#include <list>
+#include <mutex>
 
 namespace QAccessibleClient {
 
 class ObjectCache
 {
 public:
-    virtual QStringList ids() const = 0;
-    virtual QSharedPointer<AccessibleObjectPrivate> get(const QString &id) const = 0;
-    virtual void add(const QString &id, const QSharedPointer<AccessibleObjectPrivate> &objectPrivate) = 0;
-    virtual bool remove(const QString &id) = 0;
+    /**
+        Values that are cached per object next to the state and interfaces.
+     */
+    enum Property {
+        Name,
+        Description,
+        Role,
+        RoleName,
+        LocalizedRoleName,
+        AccessibleId,
+        Parent,
+        IndexInParent,
+        ChildCount
+    };
+    static const int PropertyCount = ChildCount + 1;
+
+    /**
+        Fields statistics are kept for, the properties come first.
+     */
+    enum Field {
+        StateField = PropertyCount,
+        InterfacesField,
+        ChildrenField,
+        ExtentsField,
+        ObjectField ///< lookups of the objects themselves
+    };
+    static const int FieldCount = ObjectField + 1;
+
+    /**
+        What the cached values of an object depend on, taken before calling
+        the application. A reply is only cached if the stamp is still current
+        when it arrives, otherwise a change may have been reported meanwhile
+        and the reply may predate it.
+     */
+    struct Stamp {
+        bool valid = false;
+        quint32 generation = 0;
+        quint32 epoch = 0; ///< geometry epoch of the service, see setExtents()
+
+        bool operator==(const Stamp &other) const
+        {
+            return valid == other.valid && generation == other.generation && epoch == other.epoch;
+        }
+        bool operator!=(const Stamp &other) const
+        {
+            return !operator==(other);
+        }
+    };
+
+    struct Counters {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 inserts = 0;
+        quint64 evictions = 0; ///< values dropped together with their object
+        quint64 invalidations = 0; ///< values dropped because they changed
+    };
+
+    virtual QList<ObjectHandle> handles() const = 0;
+    virtual QSharedPointer<AccessibleObjectPrivate> get(ObjectHandle handle) const = 0;
+    /**
+        Like get() but neither counted nor marking the object as used, for
+        keeping cached values up to date.
+     */
+    virtual QSharedPointer<AccessibleObjectPrivate> peek(ObjectHandle handle) const = 0;
+    virtual void add(ObjectHandle handle, const QSharedPointer<AccessibleObjectPrivate> &objectPrivate) = 0;
+    virtual bool remove(ObjectHandle handle) = 0;
+    /**
+        Called by \a objectPrivate while it is deleted, only forgets \a handle
+        if it still refers to that very object.
+     */
+    virtual void removeDeleted(ObjectHandle handle, AccessibleObjectPrivate *objectPrivate) = 0;
+    /**
+        Drops every object of the service with \a serviceId and returns the
+        ones that are still referenced somewhere.
+     */
+    virtual QList<QSharedPointer<AccessibleObjectPrivate> > removeService(quint32 serviceId) = 0;
     virtual void clear() = 0;
+    virtual Stamp stamp(ObjectHandle handle) const = 0;
+    /// Returns false if values of \a handle were invalidated since \a stamp was taken.
+    bool isCurrent(ObjectHandle handle, const Stamp &stamp) const
+    {
+        return stamp.valid && this->stamp(handle).generation == stamp.generation;
+    }
+    /// Outdates calls of \a object in flight, for values updated from a signal instead of dropped.
+    virtual void changed(const AccessibleObject &object) = 0;
     virtual AccessibleObject::Interfaces interfaces(const AccessibleObject &object) = 0;
     virtual void setInterfaces(const AccessibleObject &object, AccessibleObject::Interfaces interfaces) = 0;
     virtual quint64 state(const AccessibleObject &object) = 0;
     virtual void setState(const AccessibleObject &object, quint64 state) = 0;
     virtual void cleanState(const AccessibleObject &object) = 0;
+    /// Returns an invalid QVariant if \a property is not cached for \a object.
+    virtual QVariant property(const AccessibleObject &object, Property property) = 0;
+    virtual void setProperty(const AccessibleObject &object, Property property, const QVariant &value) = 0;
+    virtual void cleanProperty(const AccessibleObject &object, Property property) = 0;
+    /// Returns false if the children of \a object are not cached.
+    virtual bool children(const AccessibleObject &object, QVector<ObjectHandle> &children) = 0;
+    /**
+        Caches the \a children of \a object. They are \a ordered if they were
+        received on the connection the events arrive on, otherwise a
+        ChildrenChanged event may be about a change they already contain.
+     */
+    virtual void setChildren(const AccessibleObject &object, const QVector<ObjectHandle> &children, bool ordered) = 0;
+    virtual void cleanChildren(const AccessibleObject &object) = 0;
+    /// Returns false if the screen extents of \a object are not cached.
+    virtual bool extents(const AccessibleObject &object, QRect &extents) = 0;
+    /// Caches \a extents as of the geometry \a epoch of the Stamp taken before the call.
+    virtual void setExtents(const AccessibleObject &object, const QRect &extents, quint32 epoch) = 0;
+    /// Invalidates the extents of \a object alone.
+    virtual void cleanExtents(const AccessibleObject &object) = 0;
+    /**
+        Invalidates the extents of all objects of the service with \a serviceId,
+        for example because one of its windows moved.
+     */
+    virtual void cleanExtents(quint32 serviceId) = 0;
+    /// Number of objects that are cached.
+    virtual int count() const = 0;
+    /// Approximate memory used by the cached objects and their values.
+    virtual qint64 approximateBytes() const = 0;
     virtual ~ObjectCache() {}
     static const quint64 StateNotFound = ~0;
+
+    const Counters &counters(int field) const
+    {
+        return m_counters[field];
+    }
+    void resetCounters()
+    {
+        for (Counters &counters : m_counters)
+            counters = Counters();
+    }
+    static const char *fieldName(int field)
+    {
+        static const char *const names[FieldCount] = {
+            "name", "description", "role", "roleName", "localizedRoleName", "accessibleId",
+            "parent", "indexInParent", "childCount", "state", "interfaces", "children", "extents", "object"
+        };
+        return names[field];
+    }
+
+    /**
+        Rough estimate of the memory an object and its cache entry occupy.
+     */
+    static qint64 approximateSize(const AccessibleObjectPrivate *objectPrivate)
+    {
+        return sizeof(AccessibleObjectPrivate) + 8 * sizeof(void*)
+                // the id, whether it was built yet or not
+                + (objectPrivate->path.size() + objectPrivate->service.size()) * sizeof(QChar)
+                + objectPrivate->actions.size() * (sizeof(QAction) + sizeof(QSharedPointer<QAction>))
+                + objectPrivate->cachedProperties.size() * (sizeof(QVariant) + 32 * sizeof(QChar))
+                + objectPrivate->cachedChildren.size() * sizeof(ObjectHandle);
+    }
+
+protected:
+    /// Counts the values of \a objectPrivate as evicted.
+    void countEvicted(const AccessibleObjectPrivate *objectPrivate)
+    {
+        ++m_counters[ObjectField].evictions;
+        if (objectPrivate->cachedState != StateNotFound)
+            ++m_counters[StateField].evictions;
+        if (objectPrivate->cachedInterfaces != AccessibleObject::InvalidInterface)
+            ++m_counters[InterfacesField].evictions;
+        if (objectPrivate->childrenCached)
+            ++m_counters[ChildrenField].evictions;
+        if (objectPrivate->extentsCached)
+            ++m_counters[ExtentsField].evictions;
+        for (auto it = objectPrivate->cachedProperties.constBegin(); it != objectPrivate->cachedProperties.constEnd(); ++it)
+            ++m_counters[it.key()].evictions;
+    }
+
+    mutable Counters m_counters[FieldCount];
 };
 
+/**
+    Remembers objects without keeping them alive.
+
+    Objects are partitioned by the service they belong to so that everything
+    an application exposed can be dropped at once when it leaves the bus.
+ */
 class CacheWeakStrategy : public ObjectCache
 {
 public:
-    QStringList ids() const override
+    QList<ObjectHandle> handles() const override
+    {
+        QList<ObjectHandle> result;
+        for (const Partition &partition : accessibleObjectsHash)
+            result.append(partition.keys());
+        return result;
+    }
+    QSharedPointer<AccessibleObjectPrivate> get(ObjectHandle handle) const override
+    {
+        const QSharedPointer<AccessibleObjectPrivate> objectPrivate = CacheWeakStrategy::peek(handle);
+        if (objectPrivate)
+            ++m_counters[ObjectField].hits;
+        else
+            ++m_counters[ObjectField].misses;
+        return objectPrivate;
+    }
+    QSharedPointer<AccessibleObjectPrivate> peek(ObjectHandle handle) const override
+    {
+        const auto partition = accessibleObjectsHash.constFind(ObjectHandles::serviceId(handle));
+        if (partition == accessibleObjectsHash.constEnd())
+            return QSharedPointer<AccessibleObjectPrivate>();
+        return partition.value().value(handle).first.toStrongRef();
+    }
+    void add(ObjectHandle handle, const QSharedPointer<AccessibleObjectPrivate> &objectPrivate) override
     {
-        return accessibleObjectsHash.keys();
+        ++m_counters[ObjectField].inserts;
+        accessibleObjectsHash[ObjectHandles::serviceId(handle)][handle] = Entry(objectPrivate, objectPrivate.data());
     }
-    QSharedPointer<AccessibleObjectPrivate> get(const QString &id) const override
+    bool remove(ObjectHandle handle) override
     {
-        return accessibleObjectsHash[id].first;
+        const auto partition = accessibleObjectsHash.find(ObjectHandles::serviceId(handle));
+        if (partition == accessibleObjectsHash.end())
+            return false;
+        const Entry data = partition.value().take(handle);
+        if (partition.value().isEmpty())
+            accessibleObjectsHash.erase(partition);
+        const QSharedPointer<AccessibleObjectPrivate> objectPrivate = data.first.toStrongRef();
+        if (objectPrivate) {
+            countEvicted(objectPrivate.data());
+            objectPrivate->clearCachedData();
+        }
+        return data.second != nullptr;
     }
-    void add(const QString &id, const QSharedPointer<AccessibleObjectPrivate> &objectPrivate) override
+    void removeDeleted(ObjectHandle handle, AccessibleObjectPrivate *objectPrivate) override
     {
-        accessibleObjectsHash[id] = QPair<QWeakPointer<AccessibleObjectPrivate>, AccessibleObjectPrivate*>(objectPrivate, objectPrivate.data());
+        const auto partition = accessibleObjectsHash.find(ObjectHandles::serviceId(handle));
+        if (partition == accessibleObjectsHash.end())
+            return;
+        const auto it = partition.value().find(handle);
+        if (it == partition.value().end() || it.value().second != objectPrivate)
+            return;
+        partition.value().erase(it);
+        if (partition.value().isEmpty())
+            accessibleObjectsHash.erase(partition);
+        countEvicted(objectPrivate);
     }
-    bool remove(const QString &id) override
+    QList<QSharedPointer<AccessibleObjectPrivate> > removeService(quint32 serviceId) override
     {
-        QPair<QWeakPointer<AccessibleObjectPrivate>, AccessibleObjectPrivate*> data = accessibleObjectsHash.take(id);
-        return (interfaceHash.remove(data.second) >= 1) || (stateHash.remove(data.second) >= 1);
+        QList<QSharedPointer<AccessibleObjectPrivate> > alive;
+        const Partition partition = accessibleObjectsHash.take(serviceId);
+        for (const Entry &entry : partition) {
+            const QSharedPointer<AccessibleObjectPrivate> objectPrivate = entry.first.toStrongRef();
+            if (objectPrivate) {
+                countEvicted(objectPrivate.data());
+                objectPrivate->clearCachedData();
+                alive.append(objectPrivate);
+            }
+        }
+        // The id goes to the next service, extents stored for this one are outdated.
+        if (int(serviceId) < m_geometryEpochs.size())
+            ++m_geometryEpochs[serviceId];
+        return alive;
     }
     void clear() override
     {
+        for (const Partition &partition : std::as_const(accessibleObjectsHash)) {
+            for (const Entry &entry : partition) {
+                const QSharedPointer<AccessibleObjectPrivate> objectPrivate = entry.first.toStrongRef();
+                if (objectPrivate) {
+                    countEvicted(objectPrivate.data());
+                    objectPrivate->clearCachedData();
+                }
+            }
+        }
         accessibleObjectsHash.clear();
-        stateHash.clear();
-        interfaceHash.clear();
+    }
+    Stamp stamp(ObjectHandle handle) const override
+    {
+        Stamp result;
+        result.valid = true;
+        const QSharedPointer<AccessibleObjectPrivate> objectPrivate = CacheWeakStrategy::peek(handle);
+        if (objectPrivate)
+            result.generation = objectPrivate->generation;
+        result.epoch = geometryEpoch(ObjectHandles::serviceId(handle));
+        return result;
+    }
+    void changed(const AccessibleObject &object) override
+    {
+        ++object.d->generation;
     }
     AccessibleObject::Interfaces interfaces(const AccessibleObject &object) override
     {
-        if (!interfaceHash.contains(object.d.data()))
-            return AccessibleObject::InvalidInterface;
-        return interfaceHash.value(object.d.data());
+        const AccessibleObject::Interfaces interfaces = object.d->cachedInterfaces;
+        if (interfaces == AccessibleObject::InvalidInterface)
+            ++m_counters[InterfacesField].misses;
+        else
+            ++m_counters[InterfacesField].hits;
+        return interfaces;
     }
     void setInterfaces(const AccessibleObject &object, AccessibleObject::Interfaces interfaces) override
     {
-        interfaceHash.insert(object.d.data(), interfaces);
+        ++m_counters[InterfacesField].inserts;
+        object.d->cachedInterfaces = interfaces;
     }
     quint64 state(const AccessibleObject &object) override
     {
-        if (!stateHash.contains(object.d.data()))
-            return ObjectCache::StateNotFound;
-
-        return stateHash.value(object.d.data());
+        const quint64 state = object.d->cachedState;
+        if (state == ObjectCache::StateNotFound)
+            ++m_counters[StateField].misses;
+        else
+            ++m_counters[StateField].hits;
+        return state;
     }
     void setState(const AccessibleObject &object, quint64 state) override
     {
-        stateHash[object.d.data()] = state;
+        ++m_counters[StateField].inserts;
+        object.d->cachedState = state;
     }
     void cleanState(const AccessibleObject &object) override
     {
-        stateHash.remove(object.d.data());
+        if (object.d->cachedState != ObjectCache::StateNotFound)
+            ++m_counters[StateField].invalidations;
+        object.d->cachedState = ObjectCache::StateNotFound;
+        ++object.d->generation;
+    }
+    QVariant property(const AccessibleObject &object, Property property) override
+    {
+        const QVariant value = object.d->cachedProperties.value(property);
+        if (value.isValid())
+            ++m_counters[property].hits;
+        else
+            ++m_counters[property].misses;
+        return value;
+    }
+    void setProperty(const AccessibleObject &object, Property property, const QVariant &value) override
+    {
+        ++m_counters[property].inserts;
+        object.d->cachedProperties.insert(property, value);
+    }
+    void cleanProperty(const AccessibleObject &object, Property property) override
+    {
+        if (object.d->cachedProperties.remove(property))
+            ++m_counters[property].invalidations;
+        ++object.d->generation;
+    }
+    bool children(const AccessibleObject &object, QVector<ObjectHandle> &children) override
+    {
+        if (!object.d->childrenCached) {
+            ++m_counters[ChildrenField].misses;
+            return false;
+        }
+        ++m_counters[ChildrenField].hits;
+        children = object.d->cachedChildren;
+        return true;
+    }
+    void setChildren(const AccessibleObject &object, const QVector<ObjectHandle> &children, bool ordered) override
+    {
+        ++m_counters[ChildrenField].inserts;
+        object.d->setCachedChildren(children);
+        object.d->childrenOrdered = ordered;
+    }
+    void cleanChildren(const AccessibleObject &object) override
+    {
+        if (object.d->childrenCached)
+            ++m_counters[ChildrenField].invalidations;
+        object.d->clearCachedChildren();
+        ++object.d->generation;
+    }
+    bool extents(const AccessibleObject &object, QRect &extents) override
+    {
+        if (!object.d->extentsCached || object.d->extentsEpoch != geometryEpoch(ObjectHandles::serviceId(object.d->handle))) {
+            ++m_counters[ExtentsField].misses;
+            return false;
+        }
+        ++m_counters[ExtentsField].hits;
+        extents = object.d->cachedExtents;
+        return true;
+    }
+    void setExtents(const AccessibleObject &object, const QRect &extents, quint32 epoch) override
+    {
+        ++m_counters[ExtentsField].inserts;
+        object.d->cachedExtents = extents;
+        // Outdated right away if a window moved since the call was sent.
+        object.d->extentsEpoch = epoch;
+        object.d->extentsCached = true;
+    }
+    void cleanExtents(const AccessibleObject &object) override
+    {
+        ++object.d->generation;
+        if (!object.d->extentsCached)
+            return;
+        if (object.d->extentsEpoch == geometryEpoch(ObjectHandles::serviceId(object.d->handle)))
+            ++m_counters[ExtentsField].invalidations;
+        object.d->extentsCached = false;
+    }
+    void cleanExtents(quint32 serviceId) override
+    {
+        // Bumping the epoch outdates the extents of all objects of the service at once.
+        if (int(serviceId) >= m_geometryEpochs.size())
+            m_geometryEpochs.resize(serviceId + 1);
+        ++m_geometryEpochs[serviceId];
+        ++m_counters[ExtentsField].invalidations;
+    }
+    int count() const override
+    {
+        int result = 0;
+        for (const Partition &partition : accessibleObjectsHash)
+            result += partition.size();
+        return result;
+    }
+    qint64 approximateBytes() const override
+    {
+        qint64 bytes = 0;
+        for (const Partition &partition : accessibleObjectsHash) {
+            for (const Entry &entry : partition) {
+                const QSharedPointer<AccessibleObjectPrivate> objectPrivate = entry.first.toStrongRef();
+                if (objectPrivate)
+                    bytes += approximateSize(objectPrivate.data());
+            }
+        }
+        return bytes;
+    }
+
+private:
+    quint32 geometryEpoch(quint32 serviceId) const
+    {
+        return int(serviceId) < m_geometryEpochs.size() ? m_geometryEpochs.at(serviceId) : 0;
+    }
+
+    // The raw pointer tells apart a deleted object from a newer one with the same handle.
+    typedef QPair<QWeakPointer<AccessibleObjectPrivate>, AccessibleObjectPrivate*> Entry;
+    typedef QHash<ObjectHandle, Entry> Partition;
+
+    // keyed by ObjectHandles::serviceId()
+    QHash<quint32, Partition> accessibleObjectsHash;
+    // indexed by ObjectHandles::serviceId(), service ids are small and dense
+    QVector<quint32> m_geometryEpochs;
+};
+
+/**
+    Keeps the most recently used objects alive even if no AccessibleObject
+    refers to them any longer. Once more than maxObjects objects or about
+    maxBytes bytes are retained the least recently used ones are released.
+    Objects that are still referenced elsewhere stay reachable through the
+    weak index of the base class after they got released.
+ */
+class CacheStrongStrategy : public CacheWeakStrategy
+{
+public:
+    CacheStrongStrategy(int maxObjects, qint64 maxBytes)
+        : m_maxObjects(maxObjects)
+        , m_maxBytes(maxBytes)
+    {
+    }
+    ~CacheStrongStrategy() override
+    {
+        clear();
+    }
+    QSharedPointer<AccessibleObjectPrivate> get(ObjectHandle handle) const override
+    {
+        const QSharedPointer<AccessibleObjectPrivate> objectPrivate = CacheWeakStrategy::get(handle);
+        if (objectPrivate)
+            touch(handle, objectPrivate);
+        return objectPrivate;
+    }
+    void add(ObjectHandle handle, const QSharedPointer<AccessibleObjectPrivate> &objectPrivate) override
+    {
+        CacheWeakStrategy::add(handle, objectPrivate);
+        touch(handle, objectPrivate);
+    }
+    bool remove(ObjectHandle handle) override
+    {
+        // Keep the reference until the base class forgot about the object,
+        // releasing it may delete the private which calls remove() again.
+        const QSharedPointer<AccessibleObjectPrivate> released = release(handle);
+        return CacheWeakStrategy::remove(handle);
+    }
+    QList<QSharedPointer<AccessibleObjectPrivate> > removeService(quint32 serviceId) override
+    {
+        // The retained references make the base class report those objects as alive.
+        std::list<Entry> released;
+        const auto index = m_index.take(serviceId);
+        for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+            m_bytes -= it.value()->size;
+            released.splice(released.end(), m_entries, it.value());
+        }
+        return CacheWeakStrategy::removeService(serviceId);
+    }
+    void clear() override
+    {
+        const std::list<Entry> released = std::move(m_entries);
+        m_entries.clear();
+        m_index.clear();
+        m_bytes = 0;
+        CacheWeakStrategy::clear();
+    }
+
+    void setLimits(int maxObjects, qint64 maxBytes)
+    {
+        m_maxObjects = maxObjects;
+        m_maxBytes = maxBytes;
+        evict();
+    }
+    int maxObjects() const
+    {
+        return m_maxObjects;
+    }
+    qint64 maxBytes() const
+    {
+        return m_maxBytes;
+    }
+
+private:
+    struct Entry {
+        ObjectHandle handle;
+        QSharedPointer<AccessibleObjectPrivate> objectPrivate;
+        qint64 size;
+    };
+
+    void touch(ObjectHandle handle, const QSharedPointer<AccessibleObjectPrivate> &objectPrivate) const
+    {
+        const qint64 size = approximateSize(objectPrivate.data());
+        auto &index = m_index[ObjectHandles::serviceId(handle)];
+        auto it = index.constFind(handle);
+        if (it != index.constEnd()) {
+            auto entry = it.value();
+            m_bytes += size - entry->size;
+            entry->objectPrivate = objectPrivate;
+            entry->size = size;
+            m_entries.splice(m_entries.begin(), m_entries, entry);
+        } else {
+            m_entries.push_front(Entry{handle, objectPrivate, size});
+            index.insert(handle, m_entries.begin());
+            m_bytes += size;
+        }
+        evict();
+    }
+
+    void evict() const
+    {
+        while (!m_entries.empty() && (int(m_entries.size()) > m_maxObjects || m_bytes > m_maxBytes)) {
+            // The entry is unlinked before the reference is dropped, see remove().
+            const Entry entry = std::move(m_entries.back());
+            m_entries.pop_back();
+            unindex(entry.handle);
+            m_bytes -= entry.size;
+        }
+    }
+
+    QSharedPointer<AccessibleObjectPrivate> release(ObjectHandle handle)
+    {
+        const auto index = m_index.constFind(ObjectHandles::serviceId(handle));
+        if (index == m_index.constEnd() || !index.value().contains(handle))
+            return QSharedPointer<AccessibleObjectPrivate>();
+        auto entry = index.value().value(handle);
+        unindex(handle);
+        const QSharedPointer<AccessibleObjectPrivate> objectPrivate = entry->objectPrivate;
+        m_bytes -= entry->size;
+        m_entries.erase(entry);
+        return objectPrivate;
+    }
+
+    void unindex(ObjectHandle handle) const
+    {
+        const auto index = m_index.find(ObjectHandles::serviceId(handle));
+        if (index == m_index.end())
+            return;
+        index.value().remove(handle);
+        if (index.value().isEmpty())
+            m_index.erase(index);
+    }
+
+    int m_maxObjects;
+    qint64 m_maxBytes;
+    // Most recently used entries first.
+    mutable std::list<Entry> m_entries;
+    // Entries partitioned by ObjectHandles::serviceId() like the base class.
+    mutable QHash<quint32, QHash<ObjectHandle, std::list<Entry>::iterator> > m_index;
+    mutable qint64 m_bytes = 0;
+};
+
+/**
+    Access to the cache that holds the registry lock until it goes out of
+    scope. The cache is only looked up once the lock is held, it may be
+    replaced or removed by Registry::setCacheType() at any time otherwise:
+
+    \code
+    if (const LockedCache objectCache = registryPrivate->cache())
+        objectCache->property(object, ObjectCache::Name);
+    \endcode
+ */
+class LockedCache
+{
+public:
+    LockedCache(ObjectCache *const &cache, QRecursiveMutex *lock)
+        : m_locker(*lock), m_cache(cache)
+    {}
+    /// False if caching is disabled.
+    explicit operator bool() const
+    {
+        return m_cache;
+    }
+    ObjectCache *operator->() const
+    {
+        Q_ASSERT(m_cache);
+        return m_cache;
     }
 
 private:
-    QHash<QString, QPair<QWeakPointer<AccessibleObjectPrivate>, AccessibleObjectPrivate*> > accessibleObjectsHash;
-    QHash<AccessibleObjectPrivate*, AccessibleObject::Interfaces> interfaceHash;
-    QHash<AccessibleObjectPrivate*, qint64> stateHash;
+    std::unique_lock<QRecursiveMutex> m_locker;
+    ObjectCache *m_cache;
 };
 
 }
@@ -0,0 +1,84 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "calldescriptors_p.h"
+
+using namespace QAccessibleClient;
+
+const CallDescriptor &CallDescriptors::descriptor(Call call)
+{
+    // Same order as the Call enum
+    static const CallDescriptor descriptors[CallCount] = {
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetRole") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetRoleName") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetLocalizedRoleName") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetState") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetInterfaces") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetChildren") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetChildAtIndex") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetIndexInParent") },
+        { QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetApplication") },
+        { QStringLiteral("org.a11y.atspi.Application"), QStringLiteral("GetLocale") },
+        { QStringLiteral("org.a11y.atspi.Application"), QStringLiteral("GetApplicationBusAddress") },
+        { QStringLiteral("org.a11y.atspi.Component"), QStringLiteral("GetExtents") },
+        { QStringLiteral("org.a11y.atspi.Component"), QStringLiteral("GetLayer") },
+        { QStringLiteral("org.a11y.atspi.Component"), QStringLiteral("GetMDIZOrder") },
+        { QStringLiteral("org.a11y.atspi.Component"), QStringLiteral("GetAlpha") },
+        { QStringLiteral("org.a11y.atspi.Text"), QStringLiteral("GetCharacterExtents") },
+        { QStringLiteral("org.a11y.atspi.Text"), QStringLiteral("GetText") },
+        { QStringLiteral("org.a11y.atspi.Text"), QStringLiteral("GetTextAtOffset") },
+        { QStringLiteral("org.a11y.atspi.Text"), QStringLiteral("GetNSelections") },
+        { QStringLiteral("org.a11y.atspi.Text"), QStringLiteral("GetSelection") },
+        { QStringLiteral("org.a11y.atspi.Selection"), QStringLiteral("GetSelectedChild") },
+        { QStringLiteral("org.a11y.atspi.Image"), QStringLiteral("ImageDescription") },
+        { QStringLiteral("org.a11y.atspi.Image"), QStringLiteral("ImageLocale") },
+        { QStringLiteral("org.a11y.atspi.Image"), QStringLiteral("GetImageExtents") },
+        { QStringLiteral("org.a11y.atspi.Action"), QStringLiteral("GetActions") },
+        { QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("Get") },
+        { QStringLiteral("org.freedesktop.DBus.Properties"), QStringLiteral("GetAll") },
+    };
+    Q_ASSERT(call >= 0 && call < CallCount);
+    return descriptors[call];
+}
+
+const QString &CallDescriptors::name(Name name)
+{
+    // Same order as the Name enum
+    static const QString names[NameCount] = {
+        QStringLiteral("org.a11y.atspi.Accessible"),
+        QStringLiteral("Name"),
+        QStringLiteral("Description"),
+        QStringLiteral("AccessibleId"),
+        QStringLiteral("Parent"),
+        QStringLiteral("ChildCount"),
+    };
+    Q_ASSERT(name >= 0 && name < NameCount);
+    return names[name];
+}
+
+QDBusMessage CallDescriptors::methodCall(const QString &service, const QString &path, Call call)
+{
+    const CallDescriptor &d = descriptor(call);
+    return QDBusMessage::createMethodCall(service, path, d.interface, d.member);
+}
+
+// Messages built by methodCall() share the strings of the descriptor, most comparisons end at the pointers.
+static bool sameString(const QString &a, const QString &b)
+{
+    return a.constData() == b.constData() || a == b;
+}
+
+CallDescriptors::Call CallDescriptors::find(const QDBusMessage &message)
+{
+    const QString member = message.member();
+    const QString interface = message.interface();
+    for (int call = 0; call < CallCount; ++call) {
+        const CallDescriptor &d = descriptor(Call(call));
+        if (sameString(member, d.member) && sameString(interface, d.interface))
+            return Call(call);
+    }
+    return CallCount;
+}
@@ -0,0 +1,95 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef QACCESSIBILITYCLIENT_CALLDESCRIPTORS_P_H
+#define QACCESSIBILITYCLIENT_CALLDESCRIPTORS_P_H
+
+#include <QDBusMessage>
+#include <QString>
+
+namespace QAccessibleClient {
+
+/**
+    Interface and member of a dbus method call.
+ */
+struct CallDescriptor
+{
+    QString interface;
+    QString member;
+};
+
+/**
+    Prebuilt descriptors of the calls made while walking the tree.
+
+    The strings are created once and shared implicitly with every message,
+    building a call only sets destination, path and arguments instead of
+    converting the same literals to QString each time.
+ */
+class CallDescriptors
+{
+public:
+    enum Call {
+        GetRole,
+        GetRoleName,
+        GetLocalizedRoleName,
+        GetState,
+        GetInterfaces,
+        GetChildren,
+        GetChildAtIndex,
+        GetIndexInParent,
+        GetApplication,
+        GetLocale,
+        GetApplicationBusAddress,
+        GetExtents,
+        GetLayer,
+        GetMDIZOrder,
+        GetAlpha,
+        GetCharacterExtents,
+        GetText,
+        GetTextAtOffset,
+        GetNSelections,
+        GetSelection,
+        GetSelectedChild,
+        ImageDescription,
+        ImageLocale,
+        GetImageExtents,
+        GetActions,
+        PropertiesGet,
+        PropertiesGetAll,
+        CallCount
+    };
+
+    /**
+        Strings passed as arguments, the interfaces and properties read with
+        PropertiesGet and PropertiesGetAll.
+     */
+    enum Name {
+        AccessibleInterface,
+        NameProperty,
+        DescriptionProperty,
+        AccessibleIdProperty,
+        ParentProperty,
+        ChildCountProperty,
+        NameCount
+    };
+
+    static const CallDescriptor &descriptor(Call call);
+    static const QString &name(Name name);
+
+    /**
+        Returns a method call of \a call for the object at \a path on \a service.
+     */
+    static QDBusMessage methodCall(const QString &service, const QString &path, Call call);
+    /**
+        Returns the call \a message was built for, CallCount if it is none
+        of the above.
+     */
+    static Call find(const QDBusMessage &message);
+};
+
+}
+
+#endif
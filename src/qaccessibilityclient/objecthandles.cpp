@@ -0,0 +1,191 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "objecthandles_p.h"
+
+#include <QDBusArgument>
+#include <QDBusObjectPath>
+
+using namespace QAccessibleClient;
+
+Q_GLOBAL_STATIC(QString, emptyString)
+
+quint32 ObjectHandles::serviceIdFor(const QString &service)
+{
+    quint32 serviceId = m_serviceIds.value(service);
+    if (!serviceId) {
+        ServiceTable table;
+        table.service = service;
+        if (m_freeServiceIds.isEmpty()) {
+            m_services.append(table);
+            serviceId = quint32(m_services.size());
+        } else {
+            serviceId = m_freeServiceIds.takeLast();
+            m_services[serviceId - 1] = table;
+        }
+        m_serviceIds.insert(service, serviceId);
+    }
+    return serviceId;
+}
+
+quint32 ObjectHandles::pathIdFor(ServiceTable &table, const QString &path)
+{
+    quint32 pathId = table.pathIds.value(path);
+    if (!pathId) {
+        if (table.freePathIds.isEmpty()) {
+            table.paths.append(PathEntry());
+            pathId = quint32(table.paths.size());
+        } else {
+            pathId = table.freePathIds.takeLast();
+        }
+        table.paths[pathId - 1].path = path;
+        table.pathIds.insert(path, pathId);
+    }
+    return pathId;
+}
+
+ObjectHandles::PathEntry *ObjectHandles::entry(ObjectHandle handle)
+{
+    const quint32 id = serviceId(handle);
+    if (!id || int(id) > m_services.size())
+        return nullptr;
+    QVector<PathEntry> &paths = m_services[id - 1].paths;
+    const quint32 index = pathId(handle);
+    if (!index || int(index) > paths.size() || paths.at(index - 1).path.isEmpty())
+        return nullptr;
+    return &paths[index - 1];
+}
+
+void ObjectHandles::retain(ObjectHandle handle)
+{
+    PathEntry *pathEntry = entry(handle);
+    Q_ASSERT(pathEntry);
+    if (pathEntry) {
+        ++pathEntry->references;
+        ++m_services[serviceId(handle) - 1].references;
+    }
+}
+
+void ObjectHandles::release(ObjectHandle handle)
+{
+    PathEntry *pathEntry = entry(handle);
+    if (!pathEntry) {
+        // The service left the bus, its id is free with the last stale handle.
+        const quint32 id = serviceId(handle);
+        if (!id || int(id) > m_services.size())
+            return;
+        ServiceTable &table = m_services[id - 1];
+        if (table.service.isEmpty() && table.references > 0 && !--table.references)
+            m_freeServiceIds.append(id);
+        return;
+    }
+    if (pathEntry->references <= 0)
+        return;
+    ServiceTable &table = m_services[serviceId(handle) - 1];
+    --table.references;
+    if (--pathEntry->references)
+        return;
+    table.pathIds.remove(pathEntry->path);
+    pathEntry->path.clear();
+    table.freePathIds.append(pathId(handle));
+}
+
+int ObjectHandles::pathCount() const
+{
+    int count = 0;
+    for (const ServiceTable &table : m_services)
+        count += table.pathIds.size();
+    return count;
+}
+
+ObjectHandle ObjectHandles::handle(const QString &service, const QString &path)
+{
+    const quint32 serviceId = serviceIdFor(service);
+    const quint32 pathId = pathIdFor(m_services[serviceId - 1], path);
+    return (ObjectHandle(serviceId) << 32) | pathId;
+}
+
+QVector<ObjectHandle> ObjectHandles::handles(const QDBusArgument &references)
+{
+    QVector<ObjectHandle> result;
+    quint32 serviceId = 0;
+    QString service;
+    QDBusObjectPath path;
+
+    references.beginArray();
+    while (!references.atEnd()) {
+        references.beginStructure();
+        references >> service >> path;
+        references.endStructure();
+
+        const QString &pathString = path.path();
+        if (service.isEmpty() || pathString.isEmpty()) {
+            result.append(0);
+            continue;
+        }
+        if (!serviceId || m_services.at(serviceId - 1).service != service)
+            serviceId = serviceIdFor(service);
+        const quint32 pathId = pathIdFor(m_services[serviceId - 1], pathString);
+        result.append((ObjectHandle(serviceId) << 32) | pathId);
+    }
+    references.endArray();
+    return result;
+}
+
+ObjectHandle ObjectHandles::find(const QString &service, const QString &path) const
+{
+    const quint32 serviceId = m_serviceIds.value(service);
+    if (!serviceId)
+        return 0;
+    const quint32 pathId = m_services.at(serviceId - 1).pathIds.value(path);
+    if (!pathId)
+        return 0;
+    return (ObjectHandle(serviceId) << 32) | pathId;
+}
+
+quint32 ObjectHandles::findService(const QString &service) const
+{
+    return m_serviceIds.value(service);
+}
+
+void ObjectHandles::removeService(const QString &service)
+{
+    const quint32 serviceId = m_serviceIds.take(service);
+    if (!serviceId)
+        return;
+    ServiceTable &table = m_services[serviceId - 1];
+    table.service.clear();
+    table.pathIds.clear();
+    table.paths.clear();
+    table.freePathIds.clear();
+    if (!table.references)
+        m_freeServiceIds.append(serviceId);
+}
+
+const QString &ObjectHandles::service(ObjectHandle handle) const
+{
+    const quint32 id = serviceId(handle);
+    if (!id || int(id) > m_services.size())
+        return *emptyString();
+    return m_services.at(id - 1).service;
+}
+
+const QString &ObjectHandles::path(ObjectHandle handle) const
+{
+    const quint32 id = serviceId(handle);
+    if (!id || int(id) > m_services.size())
+        return *emptyString();
+    const QVector<PathEntry> &paths = m_services.at(id - 1).paths;
+    const quint32 index = pathId(handle);
+    if (!index || int(index) > paths.size())
+        return *emptyString();
+    return paths.at(index - 1).path;
+}
+
+QString ObjectHandles::id(ObjectHandle handle) const
+{
+    return path(handle) + service(handle);
+}
@@ -0,0 +1,130 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef QACCESSIBILITYCLIENT_OBJECTHANDLES_P_H
+#define QACCESSIBILITYCLIENT_OBJECTHANDLES_P_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class QDBusArgument;
+
+namespace QAccessibleClient {
+
+/**
+    Compact identifier of a remote object, the upper 32 bits identify the
+    service and the lower 32 bits the path within that service.
+    0 is never handed out and denotes an invalid object.
+ */
+typedef quint64 ObjectHandle;
+
+/**
+    Interns dbus service names and object paths and maps them to ObjectHandles.
+
+    Every service gets its own path table, the strings are stored once and
+    shared implicitly with everyone asking for them.
+
+    Handles are reference counted by the ones that keep them, the objects
+    themselves and the cached child lists. Once the last reference is gone
+    the path is forgotten and its id reused for the next new path, so
+    applications creating and destroying objects all the time do not grow
+    the tables. Handles that were never retained stay until their service
+    leaves the bus.
+
+    Service ids are reused as well, but only after the last handle retained
+    while the service was on the bus got released. Until then such stale
+    handles still point at the id of the service that left, they resolve to
+    empty strings and cannot alias objects of a newer service.
+ */
+class ObjectHandles
+{
+public:
+    /**
+        Returns the handle for \a path on \a service, creating it if needed.
+     */
+    ObjectHandle handle(const QString &service, const QString &path);
+    /**
+        Returns the handle for \a path on \a service or 0 if it was never created.
+     */
+    ObjectHandle find(const QString &service, const QString &path) const;
+    /**
+        Reads an array of object references, dbus signature a(so), straight
+        into handles. References with an empty service or path yield 0.
+
+        This skips the intermediate QSpiObjectReferenceList and looks up the
+        service only when it differs from the previous element, which is
+        rare within one child list.
+     */
+    QVector<ObjectHandle> handles(const QDBusArgument &references);
+    /**
+        Adds a reference to \a handle, which must be valid.
+     */
+    void retain(ObjectHandle handle);
+    /**
+        Drops a reference to \a handle and forgets its path with the last one.
+        Handles of services that left the bus are ignored.
+     */
+    void release(ObjectHandle handle);
+    /**
+        Returns the number of paths currently interned, over all services.
+     */
+    int pathCount() const;
+    /**
+        Returns the id of \a service or 0 if no handle was created for it.
+     */
+    quint32 findService(const QString &service) const;
+    /**
+        Forgets the path table of \a service, for example after it left the bus.
+        Its id is handed out again once no handle of it is retained any longer.
+     */
+    void removeService(const QString &service);
+
+    const QString &service(ObjectHandle handle) const;
+    const QString &path(ObjectHandle handle) const;
+
+    /**
+        Returns the id that is used for \a handle by AccessibleObject::id().
+     */
+    QString id(ObjectHandle handle) const;
+
+    static quint32 serviceId(ObjectHandle handle)
+    {
+        return quint32(handle >> 32);
+    }
+    static quint32 pathId(ObjectHandle handle)
+    {
+        return quint32(handle);
+    }
+
+private:
+    struct PathEntry {
+        QString path;
+        int references = 0;
+    };
+    struct ServiceTable {
+        QString service;
+        QHash<QString, quint32> pathIds;
+        // indexed by path id minus one, released entries have an empty path
+        QVector<PathEntry> paths;
+        QVector<quint32> freePathIds;
+        // retained handles over all paths, kept after the service left the bus
+        int references = 0;
+    };
+
+    quint32 serviceIdFor(const QString &service);
+    static quint32 pathIdFor(ServiceTable &table, const QString &path);
+    PathEntry *entry(ObjectHandle handle);
+
+    // ids start at 1, the table index is the id minus one
+    QHash<QString, quint32> m_serviceIds;
+    QVector<ServiceTable> m_services;
+    QVector<quint32> m_freeServiceIds;
+};
+
+}
+
+#endif
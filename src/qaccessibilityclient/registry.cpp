@@ -6,6 +6,7 @@
 
 #include "registry.h"
 #include "registry_p.h"
+#include "registrycache_p.h"
 
 #include <qurl.h>
 
@@ -62,8 +63,83 @@ AccessibleObject Registry::accessibleFromUrl(const QUrl &url) const
     return d->fromUrl(url);
 }
 
+void Registry::setUnresponsiveThreshold(int timeouts)
+{
+    QMutexLocker locker(&d->m_lock);
+    d->m_unresponsiveThreshold = timeouts;
+    if (timeouts <= 0) {
+        d->m_timeouts.clear();
+        const QStringList unresponsive = d->m_unresponsive.values();
+        locker.unlock();
+        for (const QString &service : unresponsive)
+            d->setResponding(service, true);
+    }
+}
+
+int Registry::unresponsiveThreshold() const
+{
+    QMutexLocker locker(&d->m_lock);
+    return d->m_unresponsiveThreshold;
+}
+
+void Registry::setUnresponsiveProbeInterval(int msec)
+{
+    QMutexLocker locker(&d->m_lock);
+    d->m_unresponsiveProbeInterval = msec;
+}
+
+int Registry::unresponsiveProbeInterval() const
+{
+    QMutexLocker locker(&d->m_lock);
+    return d->m_unresponsiveProbeInterval;
+}
+
+void Registry::setCallTimeout(const QString &name, int msec)
+{
+    QMutexLocker locker(&d->m_lock);
+    if (msec < 0)
+        d->m_callTimeouts.remove(name);
+    else
+        d->m_callTimeouts.insert(name, msec);
+}
+
+int Registry::callTimeout(const QString &name) const
+{
+    QMutexLocker locker(&d->m_lock);
+    return d->m_callTimeouts.value(name, -1);
+}
+
+void Registry::setDirectConnectionsEnabled(bool enable)
+{
+    {
+        QMutexLocker locker(&d->m_lock);
+        d->m_directConnectionsEnabled = enable;
+    }
+    if (!enable)
+        d->closeDirectConnections();
+}
+
+bool Registry::directConnectionsEnabled() const
+{
+    QMutexLocker locker(&d->m_lock);
+    return d->m_directConnectionsEnabled;
+}
+
+void Registry::setConnectionPoolSize(int size)
+{
+    d->conn.setPoolSize(size);
+}
+
+int Registry::connectionPoolSize() const
+{
+    return d->conn.poolSize();
+}
+
 Registry::CacheType Registry::cacheType() const
 {
+    QMutexLocker locker(&d->m_lock);
+    if (dynamic_cast<CacheStrongStrategy*>(d->m_cache))
+        return StrongCache;
     if (dynamic_cast<CacheWeakStrategy*>(d->m_cache))
         return WeakCache;
     return NoCache;
@@ -72,39 +148,185 @@ Registry::CacheType Registry::cacheType() const
 void Registry::setCacheType(Registry::CacheType type)
 {
     //if (cacheType() == type) return;
-    delete d->m_cache;
+    QMutexLocker locker(&d->m_lock);
+    const QStringList mirroredServices = d->m_mirrors.keys();
+    for (const QString &service : mirroredServices)
+        d->stopMirroring(service);
+    d->m_populated.clear();
+    // Objects released by the old cache remove themselves from m_cache.
+    ObjectCache *oldCache = d->m_cache;
     d->m_cache = nullptr;
+    delete oldCache;
     switch (type) {
         case NoCache:
             break;
         case WeakCache:
             d->m_cache = new CacheWeakStrategy();
             break;
+        case StrongCache:
+            d->m_cache = new CacheStrongStrategy(d->m_cacheMaxObjects, d->m_cacheMaxBytes);
+            break;
     }
+    const bool cached = d->m_cache;
+    locker.unlock();
+    // The events that invalidate cached values have to arrive even if no one subscribed to them.
+    d->setInternalEventListeners(cached ? RegistryPrivate::cacheEventListeners() : Registry::NoEventListeners);
+}
+
+void Registry::setCacheLimits(int maxObjects, qint64 maxBytes)
+{
+    QMutexLocker locker(&d->m_lock);
+    d->m_cacheMaxObjects = maxObjects;
+    d->m_cacheMaxBytes = maxBytes;
+    if (CacheStrongStrategy *cache = dynamic_cast<CacheStrongStrategy*>(d->m_cache))
+        cache->setLimits(maxObjects, maxBytes);
+}
+
+int Registry::cacheMaxObjects() const
+{
+    QMutexLocker locker(&d->m_lock);
+    return d->m_cacheMaxObjects;
+}
+
+qint64 Registry::cacheMaxBytes() const
+{
+    QMutexLocker locker(&d->m_lock);
+    return d->m_cacheMaxBytes;
 }
 
 AccessibleObject Registry::clientCacheObject(const QString &id) const
 {
-    if (d->m_cache) {
-        QSharedPointer<AccessibleObjectPrivate> p = d->m_cache->get(id);
-        if (p)
-            return AccessibleObject(p);
+    QMutexLocker locker(&d->m_lock);
+    if (!d->m_cache)
+        return AccessibleObject();
+
+    // The id is the path followed by the service. The service starts within
+    // the last element of the path, which has no dots or colons while the
+    // first element of a service name ends in one of them.
+    const int lastSlash = id.lastIndexOf(QLatin1Char('/'));
+    if (lastSlash < 0)
+        return AccessibleObject();
+    for (int start = lastSlash + 1; start < id.size(); ++start) {
+        const ObjectHandle handle = d->m_handles.find(id.mid(start), id.left(start));
+        if (handle) {
+            const QSharedPointer<AccessibleObjectPrivate> p = d->m_cache->get(handle);
+            if (p)
+                return AccessibleObject(p);
+        }
+        const QChar c = id.at(start);
+        if (c == QLatin1Char('.') || c == QLatin1Char(':'))
+            break;
     }
     return AccessibleObject();
 }
 
 QStringList Registry::clientCacheObjects() const
 {
+    QMutexLocker locker(&d->m_lock);
     QStringList result;
-    if (d->m_cache)
-        return d->m_cache->ids();
-    return QStringList();
+    if (d->m_cache) {
+        const QList<ObjectHandle> handles = d->m_cache->handles();
+        result.reserve(handles.size());
+        for (ObjectHandle handle : handles)
+            result.append(d->m_handles.id(handle));
+    }
+    return result;
 }
 
 void Registry::clearClientCache()
 {
+    // Released outside of the lock.
+    QHash<QString, QList<AccessibleObject> > populated;
+    QMutexLocker locker(&d->m_lock);
+    populated.swap(d->m_populated);
     if (d->m_cache)
         d->m_cache->clear();
 }
 
+QList<AccessibleObject> Registry::populateClientCache(const AccessibleObject &application)
+{
+    return d->populateCache(application);
+}
+
+void Registry::mirrorApplication(const AccessibleObject &application)
+{
+    d->mirrorApplication(application);
+}
+
+void Registry::stopMirroringApplication(const AccessibleObject &application)
+{
+    if (application.isValid())
+        d->stopMirroring(application.d->service);
+}
+
+CacheStatistics Registry::cacheStatistics(bool reset)
+{
+    QMutexLocker locker(&d->m_lock);
+    CacheStatistics statistics;
+    statistics.coalescedCalls = d->m_coalescedCalls;
+    if (reset)
+        d->m_coalescedCalls = 0;
+    statistics.objectPaths = d->m_handles.pathCount();
+    if (!d->m_cache)
+        return statistics;
+
+    for (int field = 0; field < ObjectCache::FieldCount; ++field) {
+        const ObjectCache::Counters &counters = d->m_cache->counters(field);
+        CacheFieldStatistics &fieldStatistics = statistics.fields[QLatin1String(ObjectCache::fieldName(field))];
+        fieldStatistics.hits = counters.hits;
+        fieldStatistics.misses = counters.misses;
+        fieldStatistics.inserts = counters.inserts;
+        fieldStatistics.evictions = counters.evictions;
+        fieldStatistics.invalidations = counters.invalidations;
+    }
+    statistics.objects = d->m_cache->count();
+    statistics.approximateBytes = d->m_cache->approximateBytes();
+
+    if (reset)
+        d->m_cache->resetCounters();
+    return statistics;
+}
+
+QHash<QString, QStringList> Registry::signatureVariants() const
+{
+    QMutexLocker locker(&d->m_lock);
+    return d->m_signatureVariants;
+}
+
+QStringList Registry::trackedServices() const
+{
+    QMutexLocker locker(&d->m_lock);
+    QSet<QString> services = d->m_busOnlyServices;
+    services.unite(d->m_resolvingServices);
+    for (auto it = d->m_directConnections.constBegin(); it != d->m_directConnections.constEnd(); ++it)
+        services.insert(it.key());
+    for (auto it = d->m_timeouts.constBegin(); it != d->m_timeouts.constEnd(); ++it)
+        services.insert(it.key());
+    for (auto it = d->m_signatureVariants.constBegin(); it != d->m_signatureVariants.constEnd(); ++it)
+        services.insert(it.key());
+    services.unite(d->m_unresponsive);
+    return services.values();
+}
+
+CallDeadline::CallDeadline(const Registry &registry, int msec)
+    : d(registry.d), m_previous(registry.d->deadline()), m_deadline(qMin(m_previous, QDeadlineTimer(msec)))
+{
+    d->setDeadline(m_deadline);
+}
+
+CallDeadline::~CallDeadline()
+{
+    d->setDeadline(m_previous);
+}
+
+bool CallDeadline::hasExpired() const
+{
+    return m_deadline.hasExpired();
+}
+
+int CallDeadline::remainingTime() const
+{
+    return qMax(qint64(0), m_deadline.remainingTime());
+}
+
 #include "moc_registry.cpp"
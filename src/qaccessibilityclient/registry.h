@@ -8,6 +8,9 @@
 #define QACCESSIBILITYCLIENT_REGISTRY_H
 
 #include <QObject>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QStringList>
 
 #include "qaccessibilityclient_export.h"
 #include "accessibleobject.h"
@@ -19,12 +22,21 @@ namespace QAccessibleClient {
 
 class RegistryPrivate;
 class RegistryPrivateCacheApi;
+class CallDeadline;
+struct CacheStatistics;
 
 /**
     This class represents the global accessibility registry.
 
     It provides information about running applications.
     All updates of accessible objects will result in signals emitted by this class.
+
+    The bus traffic is handled by a thread the registry owns. The signals are
+    emitted from that thread and reach receivers living in other threads
+    through queued connections, in the thread each receiver lives in.
+    The registry and the accessible objects it hands out can be used from
+    any thread, blocking calls only block the thread making them.
+    Set the cache up before sharing the registry between threads.
 */
 class QACCESSIBILITYCLIENT_EXPORT Registry : public QObject
 {
@@ -41,7 +53,7 @@ public:
         Focus = 0x2,                        /*!< Focus listener reacts to focus changes - see signal \sa focusChanged */
         //FocusPoint = 0x4,
 
-        //BoundsChanged = 0x8,
+        BoundsChanged = 0x8,                /*!< The extents of an accessible changed - see signal \sa boundsChanged */
         //LinkSelected = 0x10,
         StateChanged = 0x20,                /*!< State of the accessible changed - see signal \sa stateChanged */
         ChildrenChanged = 0x40,             /*!< Children changed - see signal \sa childrenChanged */
@@ -81,6 +93,9 @@ public Q_SLOTS:
         org.a11y.Status dbus interface that offers the IsEnabled property. The
         \a isEnabled and \a setEnabled methods do read/write the boolean value
         of that org.a11y.Status.IsEnabled dbus property..
+
+        The value is read once when connecting and then kept up to date from
+        the change notifications, so this does not call over dbus.
     */
     bool isEnabled() const;
     /**
@@ -95,6 +110,9 @@ public Q_SLOTS:
         This means that there is potentially a screen reader, if installed,
         that is enabled or disabled. This allows to enable system wide a
         screen reader with just one switch.
+
+        Like \a isEnabled this returns a value kept up to date from the
+        change notifications and is cheap enough to poll.
     */
     bool isScreenReaderEnabled() const;
     /**
@@ -130,6 +148,72 @@ public Q_SLOTS:
     */
     AccessibleObject accessibleFromUrl(const QUrl &url) const;
 
+    /**
+        Number of calls in a row to one application that may time out before
+        the application is considered not responding. From then on calls to it
+        fail immediately instead of blocking for the D-Bus timeout, while the
+        application is asked for its role in the background every
+        unresponsiveProbeInterval() milliseconds until it answers again.
+        0 disables this, which is the default.
+
+        \sa applicationRespondingChanged
+    */
+    void setUnresponsiveThreshold(int timeouts);
+    int unresponsiveThreshold() const;
+    /**
+        Milliseconds between two probes of an application that is not
+        responding. The default is 5000.
+    */
+    void setUnresponsiveProbeInterval(int msec);
+    int unresponsiveProbeInterval() const;
+
+    /**
+        Sets the timeout in milliseconds for calls to applications.
+
+        \a name is either an interface like "org.a11y.atspi.Text", a method
+        like "org.a11y.atspi.Text.GetText" or empty for the default of all
+        calls. The most specific one is used. A negative \a msec removes the
+        timeout again. Without any the library uses its own, 500 ms for
+        properties, children and actions and the D-Bus default otherwise.
+
+        \sa CallDeadline
+    */
+    void setCallTimeout(const QString &name, int msec);
+    /**
+        Returns the timeout set for \a name or -1 if none is set.
+    */
+    int callTimeout(const QString &name = QString()) const;
+
+    /**
+        Sends the calls to each application over a direct connection to it
+        instead of through the accessibility bus when \a enable is true.
+
+        The address is asked for with GetApplicationBusAddress in the background
+        the first time an application is called, until it is known calls go
+        through the bus. Applications that do not offer one, or whose
+        connection fails, are called through the bus as before. Signals are
+        always received through the bus, so replies and signals are not in
+        order any longer. Cached child lists are fetched again on changes
+        instead of being updated in place then. Disabled by default.
+    */
+    void setDirectConnectionsEnabled(bool enable);
+    bool directConnectionsEnabled() const;
+
+    /**
+        Spreads the calls to the applications over \a size connections to the
+        accessibility bus instead of one.
+
+        Each application is always called through the same connection, picked
+        by its service name, so blocking calls from several threads to
+        different applications do not wait for each other. Signals are always
+        received through the first connection, cached child lists of the
+        applications on the other ones are fetched again on changes instead of
+        being updated in place. Shrinking the pool closes the connections
+        beyond \a size, calls waiting on them fail. Defaults to 1.
+    */
+    void setConnectionPoolSize(int size);
+    int connectionPoolSize() const;
+
 Q_SIGNALS:
 
     /**
@@ -172,6 +256,12 @@ Q_SIGNALS:
     */
     void defunct(const QAccessibleClient::AccessibleObject &object);
 
+    /**
+        Emitted when the \a application stopped responding to calls or
+        responds again, see setUnresponsiveThreshold().
+    */
+    void applicationRespondingChanged(const QAccessibleClient::AccessibleObject &application, bool responding);
+
     /// Emitted when a window is created
     void windowCreated(const QAccessibleClient::AccessibleObject &object);
     /// Emitted when a window is destroyed
@@ -207,7 +297,8 @@ Q_SIGNALS:
     /// Emitted when a window is unshaded
     void windowUnshaded(const QAccessibleClient::AccessibleObject &object);
 
-    //void boundsChanged(const QAccessibleClient::AccessibleObject &object);
+    /// Emitted when the extents of an object changed
+    void boundsChanged(const QAccessibleClient::AccessibleObject &object);
     //void linkSelected(const QAccessibleClient::AccessibleObject &object);
 
     /**
@@ -333,13 +424,58 @@ private:
     RegistryPrivate *d;
     friend class RegistryPrivate;
     friend class RegistryPrivateCacheApi;
+    friend class CallDeadline;
 
-    enum CacheType { NoCache, WeakCache};
+    enum CacheType { NoCache, WeakCache, StrongCache };
     QACCESSIBILITYCLIENT_NO_EXPORT CacheType cacheType() const;
     QACCESSIBILITYCLIENT_NO_EXPORT void setCacheType(CacheType type);
+    QACCESSIBILITYCLIENT_NO_EXPORT void setCacheLimits(int maxObjects, qint64 maxBytes);
+    QACCESSIBILITYCLIENT_NO_EXPORT int cacheMaxObjects() const;
+    QACCESSIBILITYCLIENT_NO_EXPORT qint64 cacheMaxBytes() const;
     QACCESSIBILITYCLIENT_NO_EXPORT AccessibleObject clientCacheObject(const QString &id) const;
     QACCESSIBILITYCLIENT_NO_EXPORT QStringList clientCacheObjects() const;
     QACCESSIBILITYCLIENT_NO_EXPORT void clearClientCache();
+    QACCESSIBILITYCLIENT_NO_EXPORT QList<AccessibleObject> populateClientCache(const AccessibleObject &application);
+    QACCESSIBILITYCLIENT_NO_EXPORT void mirrorApplication(const AccessibleObject &application);
+    QACCESSIBILITYCLIENT_NO_EXPORT void stopMirroringApplication(const AccessibleObject &application);
+    QACCESSIBILITYCLIENT_NO_EXPORT CacheStatistics cacheStatistics(bool reset);
+    QACCESSIBILITYCLIENT_NO_EXPORT QHash<QString, QStringList> signatureVariants() const;
+    QACCESSIBILITYCLIENT_NO_EXPORT QStringList trackedServices() const;
+};
+
+/**
+    Limits the time all calls of a \a registry may take together while
+    the deadline exists. Only calls made from the thread that created the
+    deadline are affected.
+
+    Each call gets at most the time left and calls are not sent any longer
+    once it expired, they fail with the
+    org.kde.QAccessibilityClient.Error.DeadlineExceeded error instead.
+    This way an operation made of many calls, like walking a tree, keeps
+    to a budget as a whole. Nested deadlines can only shorten the outer one.
+
+    \code
+    {
+        CallDeadline deadline(registry, 200);
+        dumpTree(application);
+    }
+    \endcode
+*/
+class QACCESSIBILITYCLIENT_EXPORT CallDeadline
+{
+public:
+    CallDeadline(const Registry &registry, int msec);
+    ~CallDeadline();
+
+    bool hasExpired() const;
+    /// Returns the milliseconds left, never less than 0.
+    int remainingTime() const;
+
+private:
+    Q_DISABLE_COPY(CallDeadline)
+    RegistryPrivate *const d;
+    const QDeadlineTimer m_previous;
+    QDeadlineTimer m_deadline;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Registry::EventListeners)
@@ -6,6 +6,7 @@
 
 #include "registry_p.h"
 #include "registry.h"
+#include "calldescriptors_p.h"
 #include "qaccessibilityclient_debug.h"
 
 #include <QDBusMessage>
@@ -16,7 +17,12 @@
 #include <QDBusMetaType>
 
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QFutureInterface>
+#include <QPointer>
 #include <QStringList>
+#include <QTimer>
 #include <qurl.h>
 
 #include "atspi/atspi-constants.h"
@@ -35,6 +41,7 @@
 #define ATSPI_DBUS_INTERFACE_DEC "org.a11y.atspi.DeviceEventController"
 #define ATSPI_DBUS_INTERFACE_DEVICE_EVENT_LISTENER "org.a11y.atspi.DeviceEventListener"
 
+#define ATSPI_DBUS_PATH_CACHE "/org/a11y/atspi/cache"
 #define ATSPI_DBUS_INTERFACE_CACHE "org.a11y.atspi.Cache"
 #define ATSPI_DBUS_INTERFACE_ACCESSIBLE "org.a11y.atspi.Accessible"
 #define ATSPI_DBUS_INTERFACE_ACTION "org.a11y.atspi.Action"
@@ -74,17 +81,65 @@ QString RegistryPrivate::ACCESSIBLE_OBJECT_SCHEME_STRING = QLatin1String("access
 RegistryPrivate::RegistryPrivate(Registry *qq)
     :q(qq)
     , m_subscriptions(Registry::NoEventListeners)
+    , m_internalSubscriptions(Registry::NoEventListeners)
+    , m_activeSubscriptions(Registry::NoEventListeners)
 {
     qDBusRegisterMetaType<QVector<quint32> >();
+    // Signals are emitted on the I/O thread and queued to the receivers.
+    qRegisterMetaType<QAccessibleClient::AccessibleObject>();
 
     connect(&conn, SIGNAL(connectionFetched()), this, SLOT(connectionFetched()));
-    connect(&m_actionMapper, SIGNAL(mappedString(QString)), this, SLOT(actionTriggered(QString)));
     init();
+
+    m_ioThread.setObjectName(QStringLiteral("QAccessibilityClient I/O"));
+    m_ioThread.start();
+    conn.moveToThread(&m_ioThread);
+    moveToThread(&m_ioThread);
 }
 
 RegistryPrivate::~RegistryPrivate()
 {
-    delete m_cache;
+    QThread *const thread = QThread::currentThread();
+    QMetaObject::invokeMethod(this, [this, thread]() {
+        // Pending calls keep objects alive that expect the cache to still be around.
+        qDeleteAll(findChildren<QDBusPendingCallWatcher*>());
+        closeDirectConnections();
+        conn.moveToThread(thread);
+        moveToThread(thread);
+    }, thread == &m_ioThread ? Qt::DirectConnection : Qt::BlockingQueuedConnection);
+    m_ioThread.quit();
+    m_ioThread.wait();
+
+    QMutexLocker locker(&m_lock);
+    ObjectCache *cache = m_cache;
+    m_cache = nullptr;
+    delete cache;
+}
+
+void RegistryPrivate::runOnIoThread(const std::function<void()> &function) const
+{
+    if (QThread::currentThread() == &m_ioThread)
+        function();
+    else
+        QMetaObject::invokeMethod(const_cast<RegistryPrivate*>(this), function, Qt::QueuedConnection);
+}
+
+bool RegistryPrivate::subscribed(Registry::EventListener listener) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_subscriptions.testFlag(listener);
+}
+
+QDeadlineTimer RegistryPrivate::deadline() const
+{
+    if (!m_deadlines.hasLocalData())
+        return QDeadlineTimer(QDeadlineTimer::Forever);
+    return m_deadlines.localData();
+}
+
+void RegistryPrivate::setDeadline(const QDeadlineTimer &deadline)
+{
+    m_deadlines.setLocalData(deadline);
 }
 
 void RegistryPrivate::init()
@@ -112,19 +167,30 @@ void RegistryPrivate::init()
     interfaceHash[QLatin1String(ATSPI_DBUS_INTERFACE_EVENT_FOCUS)] = AccessibleObject::EventFocusInterface;
 }
 
-bool RegistryPrivate::isEnabled() const
+// Reads \a property of org.a11y.Status with a blocking call.
+static bool readStatus(const QString &property)
 {
-    if (conn.status() != DBusConnection::Connected)
-        return false;
     QDBusMessage message = QDBusMessage::createMethodCall(
                 QLatin1String("org.a11y.Bus"), QLatin1String("/org/a11y/bus"), QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"));
-    message.setArguments(QVariantList() << QLatin1String("org.a11y.Status") << QLatin1String("IsEnabled"));
+    message.setArguments(QVariantList() << QLatin1String("org.a11y.Status") << property);
     QDBusReply<QVariant> reply  = QDBusConnection::sessionBus().call(message);
     if (!reply.isValid())
         return false;
     return reply.value().toBool();
 }
 
+bool RegistryPrivate::isEnabled() const
+{
+    QMutexLocker locker(&m_lock);
+    if (m_statusFetched)
+        return m_enabled;
+    locker.unlock();
+    if (conn.status() != DBusConnection::Connected)
+        return false;
+    // Asked before the status was read in connectionFetched().
+    return readStatus(QLatin1String("IsEnabled"));
+}
+
 void RegistryPrivate::setEnabled(bool enable)
 {
     QDBusMessage message = QDBusMessage::createMethodCall(
@@ -133,20 +199,22 @@ void RegistryPrivate::setEnabled(bool enable)
     QDBusMessage reply = QDBusConnection::sessionBus().call(message);
     if (reply.type() == QDBusMessage::ErrorMessage) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not set org.a11y.Status.isEnabled." << reply.errorName() << reply.errorMessage();
+        return;
     }
+    QMutexLocker locker(&m_lock);
+    m_enabled = enable;
+    ++m_enabledGeneration;
 }
 
 bool RegistryPrivate::isScreenReaderEnabled() const
 {
+    QMutexLocker locker(&m_lock);
+    if (m_statusFetched)
+        return m_screenReaderEnabled;
+    locker.unlock();
     if (conn.status() != DBusConnection::Connected)
         return false;
-    QDBusMessage message = QDBusMessage::createMethodCall(
-                QLatin1String("org.a11y.Bus"), QLatin1String("/org/a11y/bus"), QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"));
-    message.setArguments(QVariantList() << QLatin1String("org.a11y.Status") << QLatin1String("ScreenReaderEnabled"));
-    QDBusReply<QVariant> reply  = QDBusConnection::sessionBus().call(message);
-    if (!reply.isValid())
-        return false;
-    return reply.value().toBool();
+    return readStatus(QLatin1String("ScreenReaderEnabled"));
 }
 
 void RegistryPrivate::setScreenReaderEnabled(bool enable)
@@ -157,7 +225,11 @@ void RegistryPrivate::setScreenReaderEnabled(bool enable)
     QDBusMessage reply = QDBusConnection::sessionBus().call(message);
     if (reply.type() == QDBusMessage::ErrorMessage) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not set org.a11y.Status.ScreenReaderEnabled." << reply.errorName() << reply.errorMessage();
+        return;
     }
+    QMutexLocker locker(&m_lock);
+    m_screenReaderEnabled = enable;
+    ++m_screenReaderEnabledGeneration;
 }
 
 AccessibleObject RegistryPrivate::fromUrl(const QUrl &url) const
@@ -179,23 +251,76 @@ void RegistryPrivate::connectionFetched()
         bool connected = session.connect(QLatin1String("org.a11y.Bus"), QLatin1String("/org/a11y/bus"), QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("PropertiesChanged"), this, SLOT(a11yConnectionChanged(QString,QVariantMap,QStringList)));
         if (!connected)
             qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << Q_FUNC_INFO << "Failed to connect with signal org.a11y.Status.PropertiesChanged on org.a11y.Bus";
+
+        // Read once here, a11yConnectionChanged() keeps it up to date.
+        QDBusMessage message = QDBusMessage::createMethodCall(
+                    QLatin1String("org.a11y.Bus"), QLatin1String("/org/a11y/bus"), QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("GetAll"));
+        message.setArguments(QVariantList() << QLatin1String("org.a11y.Status"));
+        // Values changed while the call is in flight are newer than its reply.
+        QMutexLocker locker(&m_lock);
+        const quint32 enabledGeneration = m_enabledGeneration;
+        const quint32 screenReaderEnabledGeneration = m_screenReaderEnabledGeneration;
+        locker.unlock();
+        runOnIoThread([this, message, enabledGeneration, screenReaderEnabledGeneration]() {
+            QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message), this);
+            connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, enabledGeneration, screenReaderEnabledGeneration](QDBusPendingCallWatcher *watcher) {
+                watcher->deleteLater();
+                const QDBusPendingReply<QVariantMap> reply = *watcher;
+                if (reply.isError()) {
+                    // The getters keep asking each time.
+                    qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not read org.a11y.Status." << reply.error().message();
+                    return;
+                }
+                const QVariantMap status = reply.value();
+                QMutexLocker locker(&m_lock);
+                if (m_enabledGeneration == enabledGeneration)
+                    m_enabled = status.value(QLatin1String("IsEnabled")).toBool();
+                if (m_screenReaderEnabledGeneration == screenReaderEnabledGeneration)
+                    m_screenReaderEnabled = status.value(QLatin1String("ScreenReaderEnabled")).toBool();
+                m_statusFetched = true;
+            });
+        });
+    }
+
+    // Applications leaving the bus take all their objects with them.
+    bool ownerChanged = conn.connection().connect(QLatin1String("org.freedesktop.DBus"), QLatin1String("/org/freedesktop/DBus"), QLatin1String("org.freedesktop.DBus"), QLatin1String("NameOwnerChanged"), this, SLOT(slotNameOwnerChanged(QString,QString,QString)));
+    if (!ownerChanged)
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << Q_FUNC_INFO << "Failed to connect with signal org.freedesktop.DBus.NameOwnerChanged";
+
+    updateEventSubscriptions();
+}
+
+void RegistryPrivate::subscribeEventListeners(const Registry::EventListeners &listeners)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_subscriptions = listeners;
     }
+    runOnIoThread([this]() { updateEventSubscriptions(); });
+}
 
-    if (m_pendingSubscriptions > 0) {
-        subscribeEventListeners(m_pendingSubscriptions);
-        m_pendingSubscriptions = {};
+void RegistryPrivate::setInternalEventListeners(const Registry::EventListeners &listeners)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_internalSubscriptions = listeners;
     }
+    runOnIoThread([this]() { updateEventSubscriptions(); });
 }
 
-void RegistryPrivate::subscribeEventListeners(const Registry::EventListeners &listeners)
+void RegistryPrivate::updateEventSubscriptions()
 {
-    if (conn.isFetchingConnection()) {
-        m_pendingSubscriptions = listeners;
+    // connectionFetched() catches up once the connection is there
+    if (conn.isFetchingConnection())
         return;
-    }
 
-    Registry::EventListeners addedListeners = listeners & ~m_subscriptions;
-    Registry::EventListeners removedListeners = m_subscriptions & ~listeners;
+    QMutexLocker locker(&m_lock);
+    const Registry::EventListeners listeners = m_subscriptions | m_internalSubscriptions;
+    locker.unlock();
+    if (listeners == m_activeSubscriptions)
+        return;
+    Registry::EventListeners addedListeners = listeners & ~m_activeSubscriptions;
+    Registry::EventListeners removedListeners = m_activeSubscriptions & ~listeners;
 
     QStringList newSubscriptions;
     QStringList removedSubscriptions;
@@ -289,6 +414,16 @@ void RegistryPrivate::subscribeEventListeners(const Registry::EventListeners &li
         if (!success) qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not subscribe to accessibility ChildrenChanged events.";
     }
 
+    if (removedListeners.testFlag(Registry::BoundsChanged)) {
+        removedSubscriptions << QLatin1String("object:bounds-changed");
+    } else if (addedListeners.testFlag(Registry::BoundsChanged)) {
+        newSubscriptions << QLatin1String("object:bounds-changed");
+        bool success = conn.connection().connect(
+                    QString(), QLatin1String(""), QLatin1String("org.a11y.atspi.Event.Object"), QLatin1String("BoundsChanged"),
+                    this, SLOT(slotBoundsChanged(QString,int,int,QDBusVariant,QAccessibleClient::QSpiObjectReference)));
+        if (!success) qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not subscribe to accessibility BoundsChanged events.";
+    }
+
     if (removedListeners.testFlag(Registry::VisibleDataChanged)) {
         removedSubscriptions << QLatin1String("object:visibledata-changed");
     } else if (addedListeners.testFlag(Registry::VisibleDataChanged)) {
@@ -321,11 +456,15 @@ void RegistryPrivate::subscribeEventListeners(const Registry::EventListeners &li
     }
 
     // we need state-changed-focus for focus events
-    if ((removedListeners.testFlag(Registry::StateChanged) || removedListeners.testFlag(Registry::Focus))
-            && (!(addedListeners.testFlag(Registry::StateChanged) || addedListeners.testFlag(Registry::Focus)))) {
+    const Registry::EventListeners stateListeners = Registry::StateChanged | Registry::Focus;
+    if (removedListeners.testFlag(Registry::Focus)) {
+        removedSubscriptions << QLatin1String("focus:");
+    } else if (addedListeners.testFlag(Registry::Focus)) {
+        newSubscriptions << QLatin1String("focus:");
+    }
+    if ((m_activeSubscriptions & stateListeners) && !(listeners & stateListeners)) {
         removedSubscriptions << QLatin1String("object:state-changed");
-    } else if (addedListeners.testFlag(Registry::StateChanged) || addedListeners.testFlag(Registry::Focus)) {
-        if (listeners.testFlag(Registry::Focus)) newSubscriptions << QLatin1String("focus:");
+    } else if (!(m_activeSubscriptions & stateListeners) && (listeners & stateListeners)) {
         newSubscriptions << QLatin1String("object:state-changed");
         bool success = conn.connection().connect(
                     QString(), QLatin1String(""), QLatin1String("org.a11y.atspi.Event.Object"), QLatin1String("StateChanged"),
@@ -392,7 +531,7 @@ void RegistryPrivate::subscribeEventListeners(const Registry::EventListeners &li
         conn.connection().asyncCall(m);
     }
 
-    m_subscriptions = listeners;
+    m_activeSubscriptions = listeners;
 
 // accerciser
 //     (u':1.7', u'Object:StateChanged:'),
@@ -433,7 +572,8 @@ void RegistryPrivate::subscribeEventListeners(const Registry::EventListeners &li
 
 Registry::EventListeners RegistryPrivate::eventListeners() const
 {
-    return m_subscriptions | m_pendingSubscriptions;
+    QMutexLocker locker(&m_lock);
+    return m_subscriptions;
 }
 
 void RegistryPrivate::slotSubscribeEventListenerFinished(QDBusPendingCallWatcher *call)
@@ -451,28 +591,62 @@ void RegistryPrivate::a11yConnectionChanged(const QString &interface,const QVari
         return;
     if (interface == QLatin1String("org.a11y.Status")) {
         QVariantMap::ConstIterator IsEnabledIt = changedProperties.constFind(QLatin1String("IsEnabled"));
-        if (IsEnabledIt != changedProperties.constEnd())
-            Q_EMIT q->enabledChanged(IsEnabledIt.value().toBool());
-        else if (invalidatedProperties.contains(QLatin1String("IsEnabled")))
-            Q_EMIT q->enabledChanged(isEnabled());
+        const bool enabledChanged = IsEnabledIt != changedProperties.constEnd();
+        if (enabledChanged || invalidatedProperties.contains(QLatin1String("IsEnabled"))) {
+            const bool enabled = enabledChanged ? IsEnabledIt.value().toBool() : readStatus(QLatin1String("IsEnabled"));
+            {
+                QMutexLocker locker(&m_lock);
+                m_enabled = enabled;
+                ++m_enabledGeneration;
+            }
+            Q_EMIT q->enabledChanged(enabled);
+        }
 
         QVariantMap::ConstIterator ScreenReaderEnabledIt = changedProperties.constFind(QLatin1String("ScreenReaderEnabled"));
-        if (ScreenReaderEnabledIt != changedProperties.constEnd())
-            Q_EMIT q->screenReaderEnabledChanged(ScreenReaderEnabledIt.value().toBool());
-        else if (invalidatedProperties.contains(QLatin1String("ScreenReaderEnabled")))
-            Q_EMIT q->screenReaderEnabledChanged(isScreenReaderEnabled());
+        const bool screenReaderChanged = ScreenReaderEnabledIt != changedProperties.constEnd();
+        if (screenReaderChanged || invalidatedProperties.contains(QLatin1String("ScreenReaderEnabled"))) {
+            const bool enabled = screenReaderChanged ? ScreenReaderEnabledIt.value().toBool() : readStatus(QLatin1String("ScreenReaderEnabled"));
+            {
+                QMutexLocker locker(&m_lock);
+                m_screenReaderEnabled = enabled;
+                ++m_screenReaderEnabledGeneration;
+            }
+            Q_EMIT q->screenReaderEnabledChanged(enabled);
+        }
     }
 }
 
 AccessibleObject RegistryPrivate::parentAccessible(const AccessibleObject &object) const
 {
-    QVariant parent = getProperty(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("Parent"));
+    QVariant cachedValue;
+    if (const LockedCache objectCache = cache())
+        cachedValue = objectCache->property(object, ObjectCache::Parent);
+    if (cachedValue.isValid())
+        return parentFromReference(object, cachedValue.value<QSpiObjectReference>());
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    const QDBusMessage message = propertyMessage(object.d->service, object.d->path, CallDescriptors::name(CallDescriptors::AccessibleInterface), CallDescriptors::name(CallDescriptors::ParentProperty));
+    return parentFromReply(object, stamp, sharedCall(message, 500));
+}
+
+AccessibleObject RegistryPrivate::parentFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &reply) const
+{
+    const QVariant parent = propertyFromReply(reply);
     if (!parent.isValid())
         return AccessibleObject();
-    const QDBusArgument arg = parent.value<QDBusArgument>();
     QSpiObjectReference ref;
+    const QDBusArgument arg = parent.value<QDBusArgument>();
     arg >> ref;
 
+    if (const LockedCache objectCache = cache()) {
+        if (objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setProperty(object, ObjectCache::Parent, QVariant::fromValue(ref));
+    }
+    return parentFromReference(object, ref);
+}
+
+AccessibleObject RegistryPrivate::parentFromReference(const AccessibleObject &object, const QSpiObjectReference &ref) const
+{
     if (ref.path.path() == object.d->path) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "WARNING: Accessible claims to be its own parent: " << object;
         return AccessibleObject();
@@ -486,37 +660,56 @@ AccessibleObject RegistryPrivate::parentAccessible(const AccessibleObject &objec
 
 int RegistryPrivate::childCount(const AccessibleObject &object) const
 {
-    QVariant childCount = getProperty(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("ChildCount"));
-    return childCount.toInt();
+    return cachedAccessibleProperty(object, ObjectCache::ChildCount, CallDescriptors::name(CallDescriptors::ChildCountProperty)).toInt();
 }
 
 int RegistryPrivate::indexInParent(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetIndexInParent"));
+    // Recorded by children() and kept up to date with the child list of the parent.
+    if (const LockedCache objectCache = cache()) {
+        const QVariant cachedValue = objectCache->property(object, ObjectCache::IndexInParent);
+        if (cachedValue.isValid())
+            return cachedValue.toInt();
+    }
 
-    QDBusReply<int> reply = conn.connection().call(message);
-    if (!reply.isValid()) {
-        QDBusReply<uint> reply2 = conn.connection().call(message);
-        if (reply2.isValid()) {
-            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Found old api returning uint in GetIndexInParent." << reply.error().message();
-            return static_cast<int>(reply.value());
-        }
-        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access index in parent." << reply.error().message();
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetIndexInParent);
+
+    const QDBusMessage reply = sharedCall(message);
+    if (reply.type() != QDBusMessage::ReplyMessage || reply.arguments().isEmpty()) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access index in parent." << reply.errorMessage();
         return -1;
     }
-    return reply.value();
+
+    const QVariant value = reply.arguments().at(0);
+    int index;
+    if (value.userType() == QMetaType::Int) {
+        index = value.toInt();
+    } else if (value.userType() == QMetaType::UInt) {
+        recordSignatureVariant(object.d->service, QLatin1String("GetIndexInParent(u)"));
+        index = static_cast<int>(value.toUInt());
+    } else {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Unexpected reply to GetIndexInParent." << reply.signature();
+        return -1;
+    }
+    return index;
 }
 
 AccessibleObject RegistryPrivate::child(const AccessibleObject &object, int index) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetChildAtIndex"));
+    {
+        // Held until the handle is resolved, released handles are reused.
+        QMutexLocker locker(&m_lock);
+        QVector<ObjectHandle> children;
+        if (m_cache && cache()->children(object, children) && index >= 0 && index < children.size())
+            return accessibleFromHandle(children.at(index));
+    }
+
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetChildAtIndex);
     QVariantList args;
     args << index;
     message.setArguments(args);
 
-    QDBusReply<QSpiObjectReference> reply = conn.connection().call(message);
+    QDBusReply<QSpiObjectReference> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access child." << reply.error().message();
         return AccessibleObject();
@@ -529,19 +722,74 @@ QList<AccessibleObject> RegistryPrivate::children(const AccessibleObject &object
 {
     QList<AccessibleObject> accs;
 
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetChildren"));
+    {
+        // Held until the handles are resolved, released handles are reused.
+        QMutexLocker locker(&m_lock);
+        QVector<ObjectHandle> handles;
+        if (m_cache && cache()->children(object, handles)) {
+            accs.reserve(handles.size());
+            for (ObjectHandle handle : std::as_const(handles))
+                accs.append(accessibleFromHandle(handle));
+            return accs;
+        }
+    }
 
-    QDBusReply<QSpiObjectReferenceList> reply = conn.connection().call(message, QDBus::Block, 500);
-    if (!reply.isValid()) {
-        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access children." << reply.error().message();
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    const bool ordered = orderedWithEvents(object.d->service);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetChildren);
+
+    return childrenFromReply(object, stamp, ordered, sharedCall(message, 500));
+}
+
+QList<AccessibleObject> RegistryPrivate::childrenFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, bool ordered, const QDBusMessage &message) const
+{
+    QList<AccessibleObject> accs;
+
+    if (message.type() != QDBusMessage::ReplyMessage || message.signature() != QLatin1String("a(so)")) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access children." << message.errorMessage() << message.signature();
         return accs;
     }
 
-    const QSpiObjectReferenceList children = reply.value();
-    for (const QSpiObjectReference &child : children) {
-        accs.append(AccessibleObject(const_cast<RegistryPrivate*>(this), child.service, child.path.path()));
+    // Decoded right into handles, child lists can be long.
+    ObjectHandles &objectHandles = const_cast<RegistryPrivate*>(this)->m_handles;
+    const QVariant references = message.arguments().at(0);
+    QVector<ObjectHandle> handles;
+    QMutexLocker locker(&m_lock);
+    if (references.userType() == qMetaTypeId<QDBusArgument>()) {
+        handles = objectHandles.handles(references.value<QDBusArgument>());
+    } else {
+        // Replies that never left the process are not marshalled.
+        const QSpiObjectReferenceList children = references.value<QSpiObjectReferenceList>();
+        handles.reserve(children.size());
+        for (const QSpiObjectReference &child : children)
+            handles.append(child.service.isEmpty() || child.path.path().isEmpty() ? 0 : objectHandles.handle(child.service, child.path.path()));
+    }
+
+    QSpiObjectReference parentReference;
+    parentReference.service = object.d->service;
+    parentReference.path = QDBusObjectPath(object.d->path);
+    const QVariant parentValue = QVariant::fromValue(parentReference);
+    // A change reported while the call was in flight may not be in the reply.
+    const bool current = m_cache && m_cache->isCurrent(object.d->handle, stamp);
+
+    accs.reserve(handles.size());
+    for (int i = 0; i < handles.size(); ++i) {
+        accs.append(accessibleFromHandle(handles.at(i)));
+        if (current && accs.last().isValid()) {
+            // Spares the Parent and GetIndexInParent calls when walking back up.
+            cache()->setProperty(accs.last(), ObjectCache::Parent, parentValue);
+            cache()->setProperty(accs.last(), ObjectCache::IndexInParent, i);
+        }
+    }
+
+    // Kept up to date by slotChildrenChanged()
+    if (current) {
+        const LockedCache objectCache = cache();
+        objectCache->setChildren(object, handles, ordered);
+        objectCache->setProperty(object, ObjectCache::ChildCount, handles.size());
     }
+    // The handles stay locked until retained by the objects or the cache.
+    locker.unlock();
 
     return accs;
 }
@@ -553,25 +801,56 @@ QList<AccessibleObject> RegistryPrivate::topLevelAccessibles() const
     return children(AccessibleObject(const_cast<RegistryPrivate*>(this), service, path));
 }
 
+ObjectCache::Stamp RegistryPrivate::cacheStamp(const AccessibleObject &object) const
+{
+    if (const LockedCache objectCache = cache())
+        return objectCache->stamp(object.d->handle);
+    return ObjectCache::Stamp();
+}
+
+QVariant RegistryPrivate::cachedAccessibleProperty(const AccessibleObject &object, ObjectCache::Property property, const QString &name) const
+{
+    if (const LockedCache objectCache = cache()) {
+        const QVariant cachedValue = objectCache->property(object, property);
+        if (cachedValue.isValid())
+            return cachedValue;
+    }
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    const QDBusMessage message = propertyMessage(object.d->service, object.d->path, CallDescriptors::name(CallDescriptors::AccessibleInterface), name);
+    return accessiblePropertyFromReply(object, stamp, property, sharedCall(message, 500));
+}
+
+QVariant RegistryPrivate::accessiblePropertyFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, ObjectCache::Property property, const QDBusMessage &reply) const
+{
+    const QVariant value = propertyFromReply(reply);
+    if (value.isValid()) {
+        const LockedCache objectCache = cache();
+        if (objectCache && objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setProperty(object, property, value);
+    }
+    return value;
+}
+
 QString RegistryPrivate::accessibleId(const AccessibleObject &object) const
 {
     if (!object.isValid())
         return QString();
-    return getProperty(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("AccessibleId")).toString();
+    return cachedAccessibleProperty(object, ObjectCache::AccessibleId, CallDescriptors::name(CallDescriptors::AccessibleIdProperty)).toString();
 }
 
 QString RegistryPrivate::name(const AccessibleObject &object) const
 {
     if (!object.isValid())
         return QString();
-    return getProperty(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("Name")).toString();
+    return cachedAccessibleProperty(object, ObjectCache::Name, CallDescriptors::name(CallDescriptors::NameProperty)).toString();
 }
 
 QString RegistryPrivate::description(const AccessibleObject &object) const
 {
     if (!object.isValid())
         return QString();
-    return getProperty(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("Description")).toString();
+    return cachedAccessibleProperty(object, ObjectCache::Description, CallDescriptors::name(CallDescriptors::DescriptionProperty)).toString();
 }
 
 AccessibleObject::Role RegistryPrivate::role(const AccessibleObject &object) const
@@ -579,15 +858,33 @@ AccessibleObject::Role RegistryPrivate::role(const AccessibleObject &object) con
     if (!object.isValid())
         return AccessibleObject::NoRole;
 
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetRole"));
+    if (const LockedCache objectCache = cache()) {
+        const QVariant cachedValue = objectCache->property(object, ObjectCache::Role);
+        if (cachedValue.isValid())
+            return static_cast<AccessibleObject::Role>(cachedValue.toInt());
+    }
 
-    QDBusReply<uint> reply = conn.connection().call(message);
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetRole);
+
+    return roleFromReply(object, stamp, sharedCall(message));
+}
+
+AccessibleObject::Role RegistryPrivate::roleFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &message) const
+{
+    QDBusReply<uint> reply(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access role." << reply.error().message();
         return AccessibleObject::NoRole;
     }
-    return atspiRoleToRole(static_cast<AtspiRole>(reply.value()));
+    const AccessibleObject::Role role = atspiRoleToRole(static_cast<AtspiRole>(reply.value()));
+
+    if (const LockedCache objectCache = cache()) {
+        if (objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setProperty(object, ObjectCache::Role, static_cast<int>(role));
+    }
+
+    return role;
 }
 
 AccessibleObject::Role RegistryPrivate::atspiRoleToRole(AtspiRole role)
@@ -703,42 +1000,76 @@ AccessibleObject::Role RegistryPrivate::atspiRoleToRole(AtspiRole role)
 
 QString RegistryPrivate::roleName(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetRoleName"));
+    if (const LockedCache objectCache = cache()) {
+        const QVariant cachedValue = objectCache->property(object, ObjectCache::RoleName);
+        if (cachedValue.isValid())
+            return cachedValue.toString();
+    }
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetRoleName);
+
+    return roleNameFromReply(object, stamp, sharedCall(message));
+}
 
-    QDBusReply<QString> reply = conn.connection().call(message);
+QString RegistryPrivate::roleNameFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &message) const
+{
+    QDBusReply<QString> reply(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access roleName." << reply.error().message();
         return QString();
     }
+
+    if (const LockedCache objectCache = cache()) {
+        if (objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setProperty(object, ObjectCache::RoleName, reply.value());
+    }
+
     return reply.value();
 }
 
 QString RegistryPrivate::localizedRoleName(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetLocalizedRoleName"));
+    if (const LockedCache objectCache = cache()) {
+        const QVariant cachedValue = objectCache->property(object, ObjectCache::LocalizedRoleName);
+        if (cachedValue.isValid())
+            return cachedValue.toString();
+    }
 
-    QDBusReply<QString> reply = conn.connection().call(message);
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetLocalizedRoleName);
+
+    QDBusReply<QString> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access localizedRoleName." << reply.error().message();\
         return QString();
     }
+
+    if (const LockedCache objectCache = cache()) {
+        if (objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setProperty(object, ObjectCache::LocalizedRoleName, reply.value());
+    }
+
     return reply.value();
 }
 
 quint64 RegistryPrivate::state(const AccessibleObject &object) const
 {
-    if (m_cache) {
-        quint64 cachedValue = m_cache->state(object);
+    if (const LockedCache objectCache = cache()) {
+        quint64 cachedValue = objectCache->state(object);
         if (cachedValue != QAccessibleClient::ObjectCache::StateNotFound)
             return cachedValue;
     }
 
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetState"));
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetState);
 
-    QDBusReply<QVector<quint32> > reply = conn.connection().call(message);
+    return stateFromReply(object, stamp, sharedCall(message));
+}
+
+quint64 RegistryPrivate::stateFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &message) const
+{
+    QDBusReply<QVector<quint32> > reply(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access state." << reply.error().message();
         return 0;
@@ -751,18 +1082,149 @@ quint64 RegistryPrivate::state(const AccessibleObject &object) const
     const quint32 high = reply.value().at(1);
     const quint64 state = low + (static_cast<quint64>(high) << 32);
 
-    if (m_cache) {
-        m_cache->setState(object, state);
+    if (const LockedCache objectCache = cache()) {
+        if (objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setState(object, state);
     }
 
     return state;
 }
 
+QString RegistryPrivate::stateString(quint64 state, AccessibleObject::Role role)
+{
+    const auto has = [state](AtspiStateType type) {
+        return state & (quint64(1) << type);
+    };
+    // Keep in sync with AccessibleObject::isCheckable()
+    const bool checkable = role == AccessibleObject::CheckBox ||
+            role == AccessibleObject::CheckableMenuItem ||
+            role == AccessibleObject::RadioButton ||
+            role == AccessibleObject::RadioMenuItem ||
+            role == AccessibleObject::ToggleButton;
+
+    QStringList s;
+    if (has(ATSPI_STATE_ACTIVE)) s << QStringLiteral("Active");
+    if (checkable) s << QStringLiteral("Checkable");
+    if (has(ATSPI_STATE_CHECKED)) s << QStringLiteral("Checked");
+    if (has(ATSPI_STATE_EDITABLE)) s << QStringLiteral("Editable");
+    if (has(ATSPI_STATE_EXPANDABLE)) s << QStringLiteral("Expandable");
+    if (has(ATSPI_STATE_EXPANDED)) s << QStringLiteral("Expanded");
+    if (has(ATSPI_STATE_FOCUSABLE)) s << QStringLiteral("Focusable");
+    if (has(ATSPI_STATE_FOCUSED)) s << QStringLiteral("Focused");
+    if (has(ATSPI_STATE_MULTI_LINE)) s << QStringLiteral("MultiLine");
+    if (has(ATSPI_STATE_SELECTABLE)) s << QStringLiteral("Selectable");
+    if (has(ATSPI_STATE_SELECTED)) s << QStringLiteral("Selected");
+    if (has(ATSPI_STATE_SENSITIVE)) s << QStringLiteral("Sensitive");
+    if (has(ATSPI_STATE_SINGLE_LINE)) s << QStringLiteral("SingleLine");
+    if (has(ATSPI_STATE_ENABLED)) s << QStringLiteral("Enabled");
+    return s.join(QLatin1String(", "));
+}
+
+AccessibleObjectInfo RegistryPrivate::info(const AccessibleObject &object) const
+{
+    AccessibleObjectInfo info;
+    if (!object.isValid())
+        return info;
+
+    typedef QPair<QDBusMessage, QDBusPendingCall> Call;
+    const auto send = [&](const QDBusMessage &message) {
+        return Call(message, sharedAsyncCall(message));
+    };
+    const auto sendMethod = [&](CallDescriptors::Call method) {
+        return send(CallDescriptors::methodCall(object.d->service, object.d->path, method));
+    };
+    const auto wait = [&](const Call &call) {
+        return waitForReply(call.first, call.second);
+    };
+    // Stands in for the calls that are answered from the cache.
+    const Call cached(QDBusMessage(), QDBusPendingCall::fromCompletedCall(QDBusMessage()));
+
+    static const QPair<ObjectCache::Property, CallDescriptors::Name> cachedProperties[] = {
+        { ObjectCache::Name, CallDescriptors::NameProperty },
+        { ObjectCache::Description, CallDescriptors::DescriptionProperty },
+        { ObjectCache::AccessibleId, CallDescriptors::AccessibleIdProperty },
+        { ObjectCache::ChildCount, CallDescriptors::ChildCountProperty },
+        { ObjectCache::Parent, CallDescriptors::ParentProperty },
+    };
+    const int propertyCount = int(sizeof(cachedProperties) / sizeof(cachedProperties[0]));
+    QVariant properties[propertyCount];
+    QVariant role;
+    QVariant roleName;
+    quint64 state = ObjectCache::StateNotFound;
+    AccessibleObject::Interfaces interfaces = AccessibleObject::InvalidInterface;
+    ObjectCache::Stamp stamp;
+    if (const LockedCache objectCache = cache()) {
+        stamp = objectCache->stamp(object.d->handle);
+        for (int i = 0; i < propertyCount; ++i)
+            properties[i] = objectCache->property(object, cachedProperties[i].first);
+        role = objectCache->property(object, ObjectCache::Role);
+        roleName = objectCache->property(object, ObjectCache::RoleName);
+        state = objectCache->state(object);
+        interfaces = objectCache->interfaces(object);
+    }
+    bool propertiesCached = true;
+    for (const QVariant &property : properties)
+        propertiesCached = propertiesCached && property.isValid();
+
+    // Only the values missing from the cache are asked for, all before waiting for the first reply.
+    Call propertiesCall = cached;
+    if (!propertiesCached) {
+        QDBusMessage getAll = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::PropertiesGetAll);
+        getAll.setArguments(QVariantList() << CallDescriptors::name(CallDescriptors::AccessibleInterface));
+        propertiesCall = send(getAll);
+    }
+    const Call roleCall = role.isValid() ? cached : sendMethod(CallDescriptors::GetRole);
+    const Call roleNameCall = roleName.isValid() ? cached : sendMethod(CallDescriptors::GetRoleName);
+    const Call stateCall = state != ObjectCache::StateNotFound ? cached : sendMethod(CallDescriptors::GetState);
+    const Call interfacesCall = !(interfaces & AccessibleObject::InvalidInterface) ? cached : sendMethod(CallDescriptors::GetInterfaces);
+
+    if (!propertiesCached) {
+        QDBusReply<QVariantMap> reply(wait(propertiesCall));
+        if (reply.isValid()) {
+            const QVariantMap values = reply.value();
+            for (int i = 0; i < propertyCount; ++i) {
+                if (properties[i].isValid())
+                    continue;
+                QVariant value = values.value(CallDescriptors::name(cachedProperties[i].second));
+                if (!value.isValid())
+                    continue;
+                if (cachedProperties[i].first == ObjectCache::Parent) {
+                    if (!value.canConvert<QDBusArgument>())
+                        continue;
+                    QSpiObjectReference ref;
+                    value.value<QDBusArgument>() >> ref;
+                    value = QVariant::fromValue(ref);
+                }
+                properties[i] = value;
+                const LockedCache objectCache = cache();
+                if (objectCache && objectCache->isCurrent(object.d->handle, stamp))
+                    objectCache->setProperty(object, cachedProperties[i].first, value);
+            }
+        } else {
+            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access properties." << reply.error().message();
+        }
+    }
+    // In the order of cachedProperties.
+    info.name = properties[0].toString();
+    info.description = properties[1].toString();
+    info.accessibleId = properties[2].toString();
+    info.childCount = properties[3].toInt();
+    if (properties[4].isValid())
+        info.parent = parentFromReference(object, properties[4].value<QSpiObjectReference>());
+
+    info.role = role.isValid() ? static_cast<AccessibleObject::Role>(role.toInt()) : roleFromReply(object, stamp, wait(roleCall));
+    info.roleName = roleName.isValid() ? roleName.toString() : roleNameFromReply(object, stamp, wait(roleNameCall));
+    if (state == ObjectCache::StateNotFound)
+        state = stateFromReply(object, stamp, wait(stateCall));
+    info.stateString = stateString(state, info.role);
+    info.interfaces = !(interfaces & AccessibleObject::InvalidInterface) ? interfaces : interfacesFromReply(object, stamp, wait(interfacesCall));
+    return info;
+}
+
 int RegistryPrivate::layer(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Component"), QLatin1String("GetLayer"));
-    QDBusReply<uint> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetLayer);
+    QDBusReply<uint> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access layer." << reply.error().message();
         return 1;
@@ -772,9 +1234,8 @@ int RegistryPrivate::layer(const AccessibleObject &object) const
 
 int RegistryPrivate::mdiZOrder(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Component"), QLatin1String("GetMDIZOrder"));
-    QDBusReply<short> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetMDIZOrder);
+    QDBusReply<short> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access mdiZOrder." << reply.error().message();
         return 0;
@@ -784,9 +1245,8 @@ int RegistryPrivate::mdiZOrder(const AccessibleObject &object) const
 
 double RegistryPrivate::alpha(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Component"), QLatin1String("GetAlpha"));
-    QDBusReply<double> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetAlpha);
+    QDBusReply<double> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access alpha." << reply.error().message();
         return 1.0;
@@ -796,27 +1256,42 @@ double RegistryPrivate::alpha(const AccessibleObject &object) const
 
 QRect RegistryPrivate::boundingRect(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(
-            object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Component"), QLatin1String("GetExtents") );
+    {
+        QRect extents;
+        const LockedCache objectCache = cache();
+        if (objectCache && objectCache->extents(object, extents))
+            return extents;
+    }
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetExtents);
     QVariantList args;
     quint32 coords = ATSPI_COORD_TYPE_SCREEN;
     args << coords;
     message.setArguments(args);
 
-    QDBusReply< QRect > reply = conn.connection().call(message);
+    return extentsFromReply(object, stamp, sharedCall(message));
+}
+
+QRect RegistryPrivate::extentsFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &message) const
+{
+    QDBusReply< QRect > reply(message);
     if(!reply.isValid()){
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not get extents." << reply.error().message();
         return QRect();
     }
 
-    return QRect( reply.value() );
+    const QRect extents = reply.value();
+    if (const LockedCache objectCache = cache()) {
+        if (objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setExtents(object, extents, stamp.epoch);
+    }
+    return extents;
 }
 
 QRect RegistryPrivate::characterRect(const AccessibleObject &object, int offset) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(
-            object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"),
-                    QLatin1String("GetCharacterExtents"));
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetCharacterExtents);
 
     QVariantList args;
     quint32 coords = ATSPI_COORD_TYPE_SCREEN;
@@ -825,18 +1300,18 @@ QRect RegistryPrivate::characterRect(const AccessibleObject &object, int offset)
     message.setArguments(args);
 
 
-    QDBusReply< QRect > reply = conn.connection().call(message);
+    const QDBusMessage rawReply = sharedCall(message);
+    // Older toolkits reply with four integers instead of a struct, that reply is complete as well.
+    if (rawReply.type() == QDBusMessage::ReplyMessage && rawReply.signature() == QLatin1String("iiii")) {
+        recordSignatureVariant(object.d->service, QLatin1String("GetCharacterExtents(iiii)"));
+        const QList<QVariant> args = rawReply.arguments();
+        return QRect(args.at(0).toInt(), args.at(1).toInt(), args.at(2).toInt(), args.at(3).toInt());
+    }
+
+    QDBusReply< QRect > reply(rawReply);
     if(!reply.isValid()){
-        if (reply.error().type() == QDBusError::InvalidSignature) {
-            QDBusMessage reply2 = conn.connection().call(message);
-            if (reply2.signature() != QLatin1String("iiii")) {
-                qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not get Character Extents. " << reply.error().message();
-                return QRect();
-            }
-            QList<QVariant> args = reply2.arguments();
-            QRect rect(args.at(0).toInt(), args.at(1).toInt(), args.at(2).toInt(), args.at(3).toInt());
-            return rect;
-        }
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not get Character Extents. " << reply.error().message();
+        return QRect();
     }
 
     return reply.value();
@@ -844,35 +1319,45 @@ QRect RegistryPrivate::characterRect(const AccessibleObject &object, int offset)
 
 AccessibleObject::Interfaces RegistryPrivate::supportedInterfaces(const AccessibleObject &object) const
 {
-    if (m_cache) {
-        AccessibleObject::Interfaces interfaces = m_cache->interfaces(object);
+    if (const LockedCache objectCache = cache()) {
+        AccessibleObject::Interfaces interfaces = objectCache->interfaces(object);
         if (!(interfaces & AccessibleObject::InvalidInterface))
             return interfaces;
     }
 
-    QDBusMessage message = QDBusMessage::createMethodCall(
-            object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"),
-                    QLatin1String("GetInterfaces"));
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetInterfaces);
+
+    return interfacesFromReply(object, stamp, sharedCall(message));
+}
 
-    QDBusReply<QStringList > reply = conn.connection().call(message);
+AccessibleObject::Interfaces RegistryPrivate::interfacesFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &message) const
+{
+    QDBusReply<QStringList > reply(message);
     if(!reply.isValid()){
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not get Interfaces. " << reply.error().message();
         return AccessibleObject::NoInterface;
     }
 
-    AccessibleObject::Interfaces interfaces = AccessibleObject::NoInterface;
-    const auto values{reply.value()};
-    for (const QString &interface : values){
-        interfaces |= interfaceHash[interface];
-    }
+    const AccessibleObject::Interfaces interfaces = interfacesFromNames(reply.value());
 
-    if (m_cache) {
-        m_cache->setInterfaces(object, interfaces);
+    if (const LockedCache objectCache = cache()) {
+        if (objectCache->isCurrent(object.d->handle, stamp))
+            objectCache->setInterfaces(object, interfaces);
     }
 
     return interfaces;
 }
 
+AccessibleObject::Interfaces RegistryPrivate::interfacesFromNames(const QStringList &names) const
+{
+    AccessibleObject::Interfaces interfaces = AccessibleObject::NoInterface;
+    for (const QString &interface : names){
+        interfaces |= interfaceHash[interface];
+    }
+    return interfaces;
+}
+
 int RegistryPrivate::caretOffset(const AccessibleObject &object) const
 {
     QVariant offset= getProperty(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("CaretOffset"));
@@ -890,18 +1375,24 @@ int RegistryPrivate::characterCount(const AccessibleObject &object) const
 QList< QPair<int,int> > RegistryPrivate::textSelections(const AccessibleObject &object) const
 {
     QList< QPair<int,int> > result;
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("GetNSelections"));
-    QDBusReply<int> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetNSelections);
+    QDBusReply<int> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access GetNSelections." << reply.error().message();
         return result;
     }
     int count = reply.value();
+
+    // Send all requests before waiting, so this costs one round trip instead of one per selection.
+    QVector< QPair<QDBusMessage, QDBusPendingCall> > calls;
+    calls.reserve(count);
     for(int i = 0; i < count; ++i) {
-        QDBusMessage m = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("GetSelection"));
+        QDBusMessage m = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetSelection);
         m.setArguments(QVariantList() << i);
-        m = conn.connection().call(m);
-        QList<QVariant> args = m.arguments();
+        calls.append(qMakePair(m, sharedAsyncCall(m)));
+    }
+    for (const auto &call : std::as_const(calls)) {
+        QList<QVariant> args = waitForReply(call.first, call.second).arguments();
         if (args.count() < 2) {
             qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Invalid number of arguments. Expected=2 Actual=" << args.count();
             continue;
@@ -917,34 +1408,31 @@ QList< QPair<int,int> > RegistryPrivate::textSelections(const AccessibleObject &
 
 void RegistryPrivate::setTextSelections(const AccessibleObject &object, const QList< QPair<int,int> > &selections)
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("GetNSelections"));
-    QDBusReply<int> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetNSelections);
+    QDBusReply<int> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access GetNSelections." << reply.error().message();
         return;
     }
     int count = reply.value();
+
+    // The messages are delivered in the order they were sent, so all of them
+    // can go out at once and the replies are only checked at the end.
+    QVector< QPair<QDBusMessage, QDBusPendingCall> > calls;
     int setSel = qMin(selections.count(), count);
     for(int i = 0; i < setSel; ++i) {
         Q_ASSERT(i < selections.count());
         QPair<int,int> p = selections[i];
         QDBusMessage m = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("SetSelection"));
         m.setArguments(QVariantList() << i << p.first << p.second);
-        QDBusReply<bool> r = conn.connection().call(m);
-        if (!r.isValid()) {
-            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Failed call text.SetSelection." << r.error().message();
-            continue;
-        }
+        calls.append(qMakePair(m, guardedAsyncCall(m)));
     }
+    // Remove from the end, so the indexes still to be removed do not shift.
     int removeSel = qMax(0, count - selections.count());
-    for(int i = 0, k = selections.count(); i < removeSel; ++i, ++k) {
+    for(int k = count - 1; k >= count - removeSel; --k) {
         QDBusMessage m = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("RemoveSelection"));
         m.setArguments(QVariantList() << k);
-        QDBusReply<bool> r = conn.connection().call(m);
-        if (!r.isValid()) {
-            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Failed call text.RemoveSelection." << r.error().message();
-            continue;
-        }
+        calls.append(qMakePair(m, guardedAsyncCall(m)));
     }
     int addSel = qMax(0, selections.count() - count);
     for(int i = 0, k = count; i < addSel; ++i, ++k) {
@@ -952,19 +1440,21 @@ void RegistryPrivate::setTextSelections(const AccessibleObject &object, const QL
         QPair<int,int> p = selections[k];
         QDBusMessage m = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("AddSelection"));
         m.setArguments(QVariantList() << p.first << p.second);
-        QDBusReply<bool> r = conn.connection().call(m);
-        if (!r.isValid()) {
-            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Failed call text.AddSelection." << r.error().message();
-            continue;
-        }
+        calls.append(qMakePair(m, guardedAsyncCall(m)));
+    }
+
+    for (const auto &call : std::as_const(calls)) {
+        QDBusReply<bool> r(waitForReply(call.first, call.second));
+        if (!r.isValid())
+            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Failed call text." << call.first.member() << r.error().message();
     }
 }
 
 QString RegistryPrivate::text(const AccessibleObject &object, int startOffset, int endOffset) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("GetText"));
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetText);
     message.setArguments(QVariantList() << startOffset << endOffset);
-    QDBusReply<QString> reply = conn.connection().call(message);
+    QDBusReply<QString> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access text." << reply.error().message();
         return QString();
@@ -974,9 +1464,9 @@ QString RegistryPrivate::text(const AccessibleObject &object, int startOffset, i
 
 QString RegistryPrivate::textWithBoundary(const AccessibleObject &object, int offset, AccessibleObject::TextBoundary boundary, int *startOffset, int *endOffset) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Text"), QLatin1String("GetTextAtOffset"));
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetTextAtOffset);
     message.setArguments(QVariantList() << offset << static_cast<AtspiTextBoundaryType>(boundary));
-    QDBusMessage reply = conn.connection().call(message);
+    QDBusMessage reply = sharedCall(message);
     if (reply.type() != QDBusMessage::ReplyMessage || reply.signature() != QLatin1String("sii")) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access text." << reply.errorMessage();
         if (startOffset)
@@ -996,7 +1486,7 @@ bool RegistryPrivate::setText(const AccessibleObject &object, const QString &tex
 {
     QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.EditableText"), QLatin1String("SetTextContents"));
     message.setArguments(QVariantList() << text);
-    QDBusReply<bool> reply = conn.connection().call(message);
+    QDBusReply<bool> reply = guardedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not set text." << reply.error().message();
         return false;
@@ -1008,7 +1498,7 @@ bool RegistryPrivate::insertText(const AccessibleObject &object, const QString &
 {
     QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.EditableText"), QLatin1String("InsertText"));
     message.setArguments(QVariantList() << position << text << length);
-    QDBusReply<bool> reply = conn.connection().call(message);
+    QDBusReply<bool> reply = guardedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not insert text." << reply.error().message();
         return false;
@@ -1020,7 +1510,7 @@ bool RegistryPrivate::copyText(const AccessibleObject &object, int startPos, int
 {
     QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.EditableText"), QLatin1String("CopyText"));
     message.setArguments(QVariantList() << startPos << endPos);
-    conn.connection().call(message);
+    guardedCall(message);
     return true;
 }
 
@@ -1028,7 +1518,7 @@ bool RegistryPrivate::cutText(const AccessibleObject &object, int startPos, int
 {
     QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.EditableText"), QLatin1String("CutText"));
     message.setArguments(QVariantList() << startPos << endPos);
-    QDBusReply<bool> reply = conn.connection().call(message);
+    QDBusReply<bool> reply = guardedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not cut text." << reply.error().message();
         return false;
@@ -1040,7 +1530,7 @@ bool RegistryPrivate::deleteText(const AccessibleObject &object, int startPos, i
 {
     QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.EditableText"), QLatin1String("DeleteText"));
     message.setArguments(QVariantList() << startPos << endPos);
-    QDBusReply<bool> reply = conn.connection().call(message);
+    QDBusReply<bool> reply = guardedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not delete text." << reply.error().message();
         return false;
@@ -1052,7 +1542,7 @@ bool RegistryPrivate::pasteText(const AccessibleObject &object, int position)
 {
     QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.EditableText"), QLatin1String("PasteText"));
     message.setArguments(QVariantList() << position);
-    QDBusReply<bool> reply = conn.connection().call(message);
+    QDBusReply<bool> reply = guardedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not paste text." << reply.error().message();
         return false;
@@ -1062,9 +1552,8 @@ bool RegistryPrivate::pasteText(const AccessibleObject &object, int position)
 
 AccessibleObject RegistryPrivate::application(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(
-            object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetApplication"));
-    QDBusReply<QSpiObjectReference> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetApplication);
+    QDBusReply<QSpiObjectReference> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access application." << reply.error().message();
         return AccessibleObject();
@@ -1097,13 +1586,13 @@ QString RegistryPrivate::appLocale(const AccessibleObject &object, uint lctype)
     if (object.d->service == QLatin1String(":1.0"))
         return QString();
 
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Application"), QLatin1String("GetLocale"));
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetLocale);
 
     QVariantList args;
     args.append(lctype);
     message.setArguments(args);
 
-    QDBusReply<QString> reply = conn.connection().call(message, QDBus::Block, 500);
+    QDBusReply<QString> reply = sharedCall(message, 500);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access appLocale." << reply.error().message();
         return QString();
@@ -1113,8 +1602,8 @@ QString RegistryPrivate::appLocale(const AccessibleObject &object, uint lctype)
 
 QString RegistryPrivate::appBusAddress(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Application"), QLatin1String("GetApplicationBusAddress"));
-    QDBusReply<QString> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetApplicationBusAddress);
+    QDBusReply<QString> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << Q_FUNC_INFO << "Could not access application bus address. Error: " << reply.error().message() << " in response to: " << message;
         return QString();
@@ -1155,7 +1644,7 @@ bool RegistryPrivate::setCurrentValue(const AccessibleObject &object, double val
     arguments << QVariant::fromValue(QDBusVariant(value));
     message.setArguments(arguments);
 
-    QDBusReply<bool> reply = conn.connection().call(message);
+    QDBusReply<bool> reply = guardedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not set text." << reply.error().message();
         return false;
@@ -1168,8 +1657,8 @@ QList<AccessibleObject> RegistryPrivate::selection(const AccessibleObject &objec
     QList<AccessibleObject> result;
     int count = getProperty(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Selection"), QLatin1String("CurrentValue")).toInt();
     for(int i = 0; i < count; ++i) {
-        QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Selection"), QLatin1String("GetSelectedChild"));
-        QDBusReply<QSpiObjectReference> reply = conn.connection().call(message);
+        QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetSelectedChild);
+        QDBusReply<QSpiObjectReference> reply = sharedCall(message);
         if (!reply.isValid()) {
             qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access selection." << reply.error().message();
             return QList<AccessibleObject>();
@@ -1182,8 +1671,8 @@ QList<AccessibleObject> RegistryPrivate::selection(const AccessibleObject &objec
 
 QString RegistryPrivate::imageDescription(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Image"), QLatin1String("ImageDescription"));
-    QDBusReply<QString> reply = conn.connection().call(message);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::ImageDescription);
+    QDBusReply<QString> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access imageDescription." << reply.error().message();
         return QString();
@@ -1193,8 +1682,8 @@ QString RegistryPrivate::imageDescription(const AccessibleObject &object) const
 
 QString RegistryPrivate::imageLocale(const AccessibleObject &object) const
 {
-    const QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Image"), QLatin1String("ImageLocale"));
-    const QDBusReply<QString> reply = conn.connection().call(message, QDBus::Block, 500);
+    const QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::ImageLocale);
+    const QDBusReply<QString> reply = sharedCall(message, 500);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access imageLocale." << reply.error().message();
         return QString();
@@ -1204,12 +1693,12 @@ QString RegistryPrivate::imageLocale(const AccessibleObject &object) const
 
 QRect RegistryPrivate::imageRect(const AccessibleObject &object) const
 {
-    QDBusMessage message = QDBusMessage::createMethodCall(object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Image"), QLatin1String("GetImageExtents"));
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetImageExtents);
     QVariantList args;
     quint32 coords = ATSPI_COORD_TYPE_SCREEN;
     args << coords;
     message.setArguments(args);
-    QDBusReply<QRect> reply = conn.connection().call(message);
+    QDBusReply<QRect> reply = sharedCall(message);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access imageRect." << reply.error().message();
         return QRect();
@@ -1219,10 +1708,9 @@ QRect RegistryPrivate::imageRect(const AccessibleObject &object) const
 
 QVector< QSharedPointer<QAction> > RegistryPrivate::actions(const AccessibleObject &object)
 {
-    const QDBusMessage message = QDBusMessage::createMethodCall (
-                object.d->service, object.d->path, QLatin1String("org.a11y.atspi.Action"), QLatin1String("GetActions"));
+    const QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetActions);
 
-    const QDBusReply<QSpiActionArray> reply = conn.connection().call(message, QDBus::Block, 500);
+    const QDBusReply<QSpiActionArray> reply = sharedCall(message, 500);
     if (!reply.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access actions." << reply.error().message();
         return QVector< QSharedPointer<QAction> >();
@@ -1230,32 +1718,31 @@ QVector< QSharedPointer<QAction> > RegistryPrivate::actions(const AccessibleObje
 
     const QSpiActionArray actionArray = reply.value();
     QVector< QSharedPointer<QAction> > list;
+    const QPointer<RegistryPrivate> registry(this);
+    const QString service = object.d->service;
+    const QString path = object.d->path;
     for(int i = 0, total = actionArray.count(); i < total; ++i) {
         const QSpiAction &a = actionArray[i];
+        // Lives in the thread asking for it, triggering it touches nothing shared with other threads.
         QAction *action = new QAction();
-        const QString id = QStringLiteral("%1;%2;%3").arg(object.d->service).arg(object.d->path).arg(i);
-        action->setObjectName(id);
+        action->setObjectName(QStringLiteral("%1;%2;%3").arg(service).arg(path).arg(i));
         action->setText(a.name);
         action->setWhatsThis(a.description);
         if (!a.keyBinding.isEmpty()) {
             const QKeySequence shortcut(a.keyBinding);
             action->setShortcut(std::move(shortcut));
         }
-        m_actionMapper.setMapping(action, id);
-        connect(action, SIGNAL(triggered()), &m_actionMapper, SLOT(map()));
+        connect(action, &QAction::triggered, action, [registry, service, path, i]() {
+            if (registry)
+                registry->doAction(service, path, i);
+        });
         list.append(QSharedPointer<QAction>(action));
     }
     return list;
 }
 
-void RegistryPrivate::actionTriggered(const QString &action)
+void RegistryPrivate::doAction(const QString &service, const QString &path, int index) const
 {
-    const QStringList actionParts = action.split(QLatin1Char(';'));
-    Q_ASSERT(actionParts.count() == 3);
-    const QString service = actionParts.at(0);
-    const QString path = actionParts.at(1);
-    const int index = actionParts.at(2).toInt();
-
     QDBusMessage message = QDBusMessage::createMethodCall (
                 service, path, QLatin1String("org.a11y.atspi.Action"), QLatin1String("DoAction"));
 
@@ -1263,30 +1750,311 @@ void RegistryPrivate::actionTriggered(const QString &action)
     args << index;
     message.setArguments(args);
 
-    QDBusReply<bool> reply = conn.connection().call(message, QDBus::Block, 500);
-    if (!reply.isValid()) {
-        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not execute action=" << action << reply.error().message();
+    // Triggered from a user interface, which must not wait for the application.
+    watchReply(message, guardedAsyncCall(message, 500), [message, index](const QDBusMessage &replyMessage) {
+        const QDBusReply<bool> reply(replyMessage);
+        if (!reply.isValid()) {
+            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not execute action" << index << "of" << message.path() << reply.error().message();
+            return;
+        }
+        if (!reply.value())
+            qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Failed to execute action" << index << "of" << message.path();
+    }, []() {}, 500);
+}
+
+QList<AccessibleObject> RegistryPrivate::populateCache(const AccessibleObject &application)
+{
+    QList<AccessibleObject> objects;
+    if (!cache()) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Cannot populate the client cache, caching is disabled.";
+        return objects;
+    }
+    if (!application.isValid())
+        return objects;
+
+    QDBusMessage message = QDBusMessage::createMethodCall(
+                application.d->service, QLatin1String(ATSPI_DBUS_PATH_CACHE), QLatin1String(ATSPI_DBUS_INTERFACE_CACHE), QLatin1String("GetItems"));
+    const bool ordered = orderedWithEvents(application.d->service);
+    const QDBusMessage reply = sharedCall(message);
+    if (reply.type() != QDBusMessage::ReplyMessage) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not access cache items." << reply.errorMessage();
+        return objects;
+    }
+
+    QSpiAccessibleCacheArray items;
+    if (!readCacheItems(reply, items)) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Unexpected signature of cache items:" << reply.signature();
+        return objects;
+    }
+
+    // The cache may have been disabled while waiting for the reply.
+    QMutexLocker locker(&m_lock);
+    if (!m_cache)
+        return objects;
+    objects.reserve(items.count());
+    for (const QSpiAccessibleCacheItem &item : std::as_const(items)) {
+        objects.append(updateCache(application.d->service, item));
+    }
+    cacheChildLists(application.d->service, items, objects, ordered);
+    // Released outside of the lock.
+    const QList<AccessibleObject> previous = m_populated.value(application.d->service);
+    m_populated.insert(application.d->service, objects);
+    locker.unlock();
+    return objects;
+}
+
+void RegistryPrivate::cacheChildLists(const QString &service, const QSpiAccessibleCacheArray &items, const QList<AccessibleObject> &objects, bool ordered)
+{
+    QMutexLocker locker(&m_lock);
+    // The current layout only tells parent and index, collect the children by parent.
+    QHash<ObjectHandle, QVector<ObjectHandle> > childLists;
+    for (int i = 0; i < items.size(); ++i) {
+        const QSpiAccessibleCacheItem &item = items.at(i);
+        if (item.indexInParent < 0 || item.parent.path.path().isEmpty())
+            continue;
+        const QString parentService = item.parent.service.isEmpty() ? service : item.parent.service;
+        const ObjectHandle parent = m_handles.find(parentService, item.parent.path.path());
+        if (!parent)
+            continue;
+        QVector<ObjectHandle> &children = childLists[parent];
+        if (children.size() <= item.indexInParent)
+            children.resize(item.indexInParent + 1);
+        children[item.indexInParent] = objects.at(i).d->handle;
+    }
+
+    for (int i = 0; i < items.size(); ++i) {
+        const QSpiAccessibleCacheItem &item = items.at(i);
+        const AccessibleObject &object = objects.at(i);
+        QVector<ObjectHandle> children;
+        if (item.children.size() == item.childCount) {
+            // The legacy layout lists them, or there are none.
+            children.reserve(item.children.size());
+            for (const QSpiObjectReference &child : item.children) {
+                const QString childService = child.service.isEmpty() ? service : child.service;
+                children.append(child.path.path().isEmpty() ? 0 : m_handles.handle(childService, child.path.path()));
+            }
+        } else {
+            // Toolkits may leave out children, for example the cells of huge tables.
+            children = childLists.value(object.d->handle);
+            if (children.size() != item.childCount || children.contains(0))
+                continue;
+        }
+        cache()->setChildren(object, children, ordered);
+        for (int index = 0; index < children.size(); ++index)
+            setCachedParent(children.at(index), object, index);
+    }
+}
+
+void RegistryPrivate::mirrorApplication(const AccessibleObject &application)
+{
+    if (!cache()) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Cannot mirror an application, caching is disabled.";
+        return;
+    }
+    if (!application.isValid())
+        return;
+
+    const QString service = application.d->service;
+    {
+        QMutexLocker locker(&m_lock);
+        if (m_mirrors.contains(service))
+            return;
+        m_mirrors.insert(service, QHash<ObjectHandle, AccessibleObject>());
+    }
+
+    // Subscribe first, updates that race with GetItems are applied on top of it.
+    bool added = conn.connection().connect(
+                service, QLatin1String(ATSPI_DBUS_PATH_CACHE), QLatin1String(ATSPI_DBUS_INTERFACE_CACHE), QLatin1String("AddAccessible"),
+                this, SLOT(slotAddAccessible(QDBusMessage)));
+    bool removed = conn.connection().connect(
+                service, QLatin1String(ATSPI_DBUS_PATH_CACHE), QLatin1String(ATSPI_DBUS_INTERFACE_CACHE), QLatin1String("RemoveAccessible"),
+                this, SLOT(slotRemoveAccessible(QDBusMessage)));
+    if (!added || !removed) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not subscribe to cache updates of" << service
+                   << "added:" << added << "removed:" << removed;
+    }
+
+    const QList<AccessibleObject> objects = populateCache(application);
+    QMutexLocker locker(&m_lock);
+    const auto mirror = m_mirrors.find(service);
+    if (mirror == m_mirrors.end())
+        return;
+    for (const AccessibleObject &object : objects) {
+        mirror.value().insert(object.d->handle, object);
+    }
+}
+
+void RegistryPrivate::stopMirroring(const QString &service)
+{
+    QHash<ObjectHandle, AccessibleObject> mirror;
+    QList<AccessibleObject> populated;
+    {
+        QMutexLocker locker(&m_lock);
+        // Both are released outside of the lock.
+        populated = m_populated.take(service);
+        const auto it = m_mirrors.find(service);
+        if (it == m_mirrors.end())
+            return;
+        mirror = it.value();
+        m_mirrors.erase(it);
+    }
+
+    conn.connection().disconnect(
+                service, QLatin1String(ATSPI_DBUS_PATH_CACHE), QLatin1String(ATSPI_DBUS_INTERFACE_CACHE), QLatin1String("AddAccessible"),
+                this, SLOT(slotAddAccessible(QDBusMessage)));
+    conn.connection().disconnect(
+                service, QLatin1String(ATSPI_DBUS_PATH_CACHE), QLatin1String(ATSPI_DBUS_INTERFACE_CACHE), QLatin1String("RemoveAccessible"),
+                this, SLOT(slotRemoveAccessible(QDBusMessage)));
+}
+
+void RegistryPrivate::slotAddAccessible(const QDBusMessage &message)
+{
+    QMutexLocker locker(&m_lock);
+    auto mirror = m_mirrors.find(message.service());
+    if (mirror == m_mirrors.end() || !m_cache)
+        return;
+
+    bool legacy;
+    if (message.signature() == QLatin1String(QSPI_CACHE_ITEM_SIGNATURE)) {
+        legacy = false;
+    } else if (message.signature() == QLatin1String(QSPI_CACHE_ITEM_SIGNATURE_LEGACY)) {
+        legacy = true;
+    } else {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Unexpected signature of added cache item:" << message.signature();
+        return;
+    }
+
+    QSpiAccessibleCacheItem item;
+    readCacheItem(message.arguments().at(0).value<QDBusArgument>(), legacy, item);
+    const AccessibleObject object = updateCache(message.service(), item);
+    cacheChildLists(message.service(), QSpiAccessibleCacheArray() << item, QList<AccessibleObject>() << object, true);
+    mirror.value().insert(object.d->handle, object);
+}
+
+void RegistryPrivate::slotRemoveAccessible(const QDBusMessage &message)
+{
+    QMutexLocker locker(&m_lock);
+    auto mirror = m_mirrors.find(message.service());
+    if (mirror == m_mirrors.end())
         return;
+
+    if (message.signature() != QLatin1String("(so)")) {
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Unexpected signature of removed cache item:" << message.signature();
+        return;
+    }
+
+    QSpiObjectReference reference;
+    message.arguments().at(0).value<QDBusArgument>() >> reference;
+    if (reference.service.isEmpty())
+        reference.service = message.service();
+
+    const AccessibleObject object = mirror.value().take(m_handles.find(reference.service, reference.path.path()));
+    locker.unlock();
+    if (object.isValid())
+        removeAccessibleObject(object);
+}
+
+void RegistryPrivate::slotNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner)
+{
+    Q_UNUSED(oldOwner);
+    if (newOwner.isEmpty()) {
+        closeDirectConnection(name, false);
+        conn.releaseService(name);
+        QMutexLocker locker(&m_lock);
+        m_busOnlyServices.remove(name);
+        m_resolvingServices.remove(name);
+        m_signatureVariants.remove(name);
+        m_timeouts.remove(name);
+        m_unresponsive.remove(name);
+        locker.unlock();
+        removeService(name);
     }
+}
+
+void RegistryPrivate::removeService(const QString &service)
+{
+    QMutexLocker locker(&m_lock);
+    const quint32 serviceId = m_handles.findService(service);
+    if (!serviceId)
+        return;
 
-    if (reply.value()) {
-        qDebug() << "Successful executed action=" << action;
+    QList<QSharedPointer<AccessibleObjectPrivate> > objects;
+    if (m_cache) {
+        objects = cache()->removeService(serviceId);
+        // The application may leave before the registry announces it, refetch the list of applications.
+        const ObjectHandle root = m_handles.find(QLatin1String("org.a11y.atspi.Registry"), QLatin1String("/org/a11y/atspi/accessible/root"));
+        const QSharedPointer<AccessibleObjectPrivate> rootPrivate = root ? cache()->get(root) : QSharedPointer<AccessibleObjectPrivate>();
+        if (rootPrivate) {
+            const AccessibleObject rootObject(rootPrivate);
+            cache()->cleanChildren(rootObject);
+            cache()->cleanProperty(rootObject, ObjectCache::ChildCount);
+        }
+    }
+    // The mirror holds references too, they are part of the list by now.
+    stopMirroring(service);
+    // The id goes to the next service, which must not join calls to this one.
+    for (auto it = m_sharedCalls.begin(); it != m_sharedCalls.end();) {
+        if (ObjectHandles::serviceId(it.key().handle) == serviceId)
+            it = m_sharedCalls.erase(it);
+        else
+            ++it;
+    }
+    m_handles.removeService(service);
+    locker.unlock();
+
+    for (const QSharedPointer<AccessibleObjectPrivate> &objectPrivate : std::as_const(objects))
+        objectPrivate->setDefunct();
+    for (const QSharedPointer<AccessibleObjectPrivate> &objectPrivate : std::as_const(objects))
+        Q_EMIT q->removed(AccessibleObject(objectPrivate));
+}
+
+AccessibleObject RegistryPrivate::updateCache(const QString &service, const QSpiAccessibleCacheItem &item)
+{
+    // Checked by the callers, which hold the lock.
+    Q_ASSERT(m_cache);
+    const QString objectService = item.object.service.isEmpty() ? service : item.object.service;
+    const AccessibleObject object(this, objectService, item.object.path.path());
+
+    cache()->setInterfaces(object, interfacesFromNames(item.supportedInterfaces));
+    cache()->setProperty(object, ObjectCache::Name, item.name);
+    cache()->setProperty(object, ObjectCache::Description, item.description);
+    cache()->setProperty(object, ObjectCache::Role, static_cast<int>(atspiRoleToRole(static_cast<AtspiRole>(item.role))));
+    cache()->setProperty(object, ObjectCache::Parent, QVariant::fromValue(item.parent));
+    // Only kept in sync for children of objects whose child list is cached.
+    cache()->cleanProperty(object, ObjectCache::IndexInParent);
+    if (item.childCount >= 0)
+        cache()->setProperty(object, ObjectCache::ChildCount, item.childCount);
+    else
+        cache()->cleanProperty(object, ObjectCache::ChildCount);
+    if (item.state.size() >= 2) {
+        const quint64 state = item.state.at(0) + (static_cast<quint64>(item.state.at(1)) << 32);
+        cache()->setState(object, state);
     } else {
-        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Failed to execute action=" << action;
+        cache()->cleanState(object);
     }
+    return object;
 }
 
 QVariant RegistryPrivate::getProperty(const QString &service, const QString &path, const QString &interface, const QString &name) const
+{
+    const QDBusMessage message = propertyMessage(service, path, interface, name);
+    return propertyFromReply(sharedCall(message, 500));
+}
+
+QDBusMessage RegistryPrivate::propertyMessage(const QString &service, const QString &path, const QString &interface, const QString &name)
 {
     QVariantList args;
     args.append(interface);
     args.append(name);
 
-    QDBusMessage message = QDBusMessage::createMethodCall (
-                service, path, QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"));
+    QDBusMessage message = CallDescriptors::methodCall(service, path, CallDescriptors::PropertiesGet);
 
     message.setArguments(args);
-    const QDBusMessage reply = conn.connection().call(message, QDBus::Block, 500);
+    return message;
+}
+
+QVariant RegistryPrivate::propertyFromReply(const QDBusMessage &reply)
+{
     if (reply.arguments().isEmpty())
         return QVariant();
 
@@ -1294,6 +2062,553 @@ QVariant RegistryPrivate::getProperty(const QString &service, const QString &pat
     return v.variant();
 }
 
+bool RegistryPrivate::sharedCallKey(const QDBusMessage &message, int effectiveTimeout, SharedCallKey &key) const
+{
+    key.call = CallDescriptors::find(message);
+    if (key.call == CallDescriptors::CallCount)
+        return false;
+    key.handle = m_handles.find(message.service(), message.path());
+    if (!key.handle)
+        return false;
+    key.timeout = effectiveTimeout;
+    key.arguments = message.arguments();
+    for (const QVariant &argument : std::as_const(key.arguments)) {
+        uint hash;
+        switch (argument.userType()) {
+        case QMetaType::Int:
+            hash = qHash(argument.toInt());
+            break;
+        case QMetaType::UInt:
+            hash = qHash(argument.toUInt());
+            break;
+        case QMetaType::Bool:
+            hash = qHash(argument.toBool());
+            break;
+        case QMetaType::QString:
+            hash = qHash(argument.toString());
+            break;
+        default:
+            // Not worth comparing, send it on its own.
+            return false;
+        }
+        key.argumentsHash = key.argumentsHash * 31 + hash;
+    }
+    return true;
+}
+
+QDBusPendingCall RegistryPrivate::sharedAsyncCall(const QDBusMessage &message, int timeout) const
+{
+    // A caller with a deadline must not wait for a call that may outlast it.
+    if (!deadline().isForever())
+        return guardedAsyncCall(message, timeout);
+    const int effectiveTimeout = callTimeout(message, timeout);
+
+    QMutexLocker locker(&m_lock);
+    SharedCallKey key;
+    if (!sharedCallKey(message, effectiveTimeout, key)) {
+        locker.unlock();
+        return sendGuardedCall(message, effectiveTimeout);
+    }
+    const ObjectCache::Stamp stamp = m_cache ? m_cache->stamp(key.handle) : ObjectCache::Stamp();
+    auto it = m_sharedCalls.find(key);
+    if (it != m_sharedCalls.end()) {
+        // A reply to a call sent before the object changed may miss that change.
+        if (!it->call.isFinished() && it->stamp == stamp) {
+            ++m_coalescedCalls;
+            return it->call;
+        }
+        m_sharedCalls.erase(it);
+    }
+
+    // Finished calls are only dropped when looked up again, prune them once in a while.
+    if (m_sharedCalls.size() >= 64) {
+        for (auto pending = m_sharedCalls.begin(); pending != m_sharedCalls.end();) {
+            if (pending->call.isFinished())
+                pending = m_sharedCalls.erase(pending);
+            else
+                ++pending;
+        }
+    }
+    // Opening a direct connection may wait for the application.
+    locker.unlock();
+
+    const QDBusPendingCall call = sendGuardedCall(message, effectiveTimeout);
+    if (!call.isFinished()) {
+        locker.relock();
+        m_sharedCalls.insert(key, SharedCall{call, stamp});
+    }
+    return call;
+}
+
+QDBusMessage RegistryPrivate::sharedCall(const QDBusMessage &message, int timeout) const
+{
+    return waitForReply(message, sharedAsyncCall(message, timeout), timeout);
+}
+
+static const QLatin1String NotRespondingError("org.kde.QAccessibilityClient.Error.NotResponding");
+static const QLatin1String DeadlineExceededError("org.kde.QAccessibilityClient.Error.DeadlineExceeded");
+
+QDBusPendingCall RegistryPrivate::guardedAsyncCall(const QDBusMessage &message, int timeout) const
+{
+    return sendGuardedCall(message, callTimeout(message, timeout));
+}
+
+QDBusPendingCall RegistryPrivate::sendGuardedCall(const QDBusMessage &message, int effectiveTimeout) const
+{
+    bool unresponsive;
+    {
+        QMutexLocker locker(&m_lock);
+        unresponsive = m_unresponsive.contains(message.service());
+    }
+    if (unresponsive) {
+        return QDBusPendingCall::fromCompletedCall(message.createErrorReply(NotRespondingError,
+                QLatin1String("The application did not respond to the last calls.")));
+    }
+    if (deadline().hasExpired()) {
+        return QDBusPendingCall::fromCompletedCall(message.createErrorReply(DeadlineExceededError,
+                QLatin1String("The deadline for the call expired.")));
+    }
+    const QDBusPendingCall call = connectionFor(message.service()).asyncCall(message, effectiveTimeout);
+    watchResponsiveness(message.service(), call);
+    return call;
+}
+
+int RegistryPrivate::callTimeout(const QDBusMessage &message, int timeout) const
+{
+    QMutexLocker locker(&m_lock);
+    if (!m_callTimeouts.isEmpty()) {
+        // Only a few are set, compared in place instead of building "interface.member".
+        const QString interface = message.interface();
+        const QString member = message.member();
+        int specificity = -1;
+        for (auto it = m_callTimeouts.constBegin(); it != m_callTimeouts.constEnd(); ++it) {
+            const QString &name = it.key();
+            int match = -1;
+            if (name.isEmpty())
+                match = 0;
+            else if (name == interface)
+                match = 1;
+            else if (name.size() == interface.size() + 1 + member.size() && name.startsWith(interface)
+                     && name.at(interface.size()) == QLatin1Char('.') && name.endsWith(member))
+                match = 2;
+            if (match > specificity) {
+                specificity = match;
+                timeout = it.value();
+            }
+        }
+    }
+    locker.unlock();
+
+    const QDeadlineTimer callDeadline = deadline();
+    if (!callDeadline.isForever()) {
+        const int remaining = qMax(1, int(callDeadline.remainingTime()));
+        if (timeout < 0 || remaining < timeout)
+            timeout = remaining;
+    }
+    return timeout;
+}
+
+QDBusMessage RegistryPrivate::guardedCall(const QDBusMessage &message, int timeout) const
+{
+    return waitForReply(message, guardedAsyncCall(message, timeout), timeout);
+}
+
+QDBusMessage RegistryPrivate::waitForReply(const QDBusMessage &message, QDBusPendingCall call, int timeout) const
+{
+    call.waitForFinished();
+    QDBusMessage reply = call.reply();
+    if (directConnectionFailed(message.service(), reply)) {
+        closeDirectConnection(message.service(), true);
+        call = guardedAsyncCall(message, timeout);
+        call.waitForFinished();
+        reply = call.reply();
+    }
+    return reply;
+}
+
+void RegistryPrivate::watchReply(const QDBusMessage &message, const QDBusPendingCall &call,
+                                 const std::function<void(const QDBusMessage &)> &onReply, const std::function<void()> &onCanceled,
+                                 int timeout) const
+{
+    // The reply is decoded on the I/O thread, whoever asked for it.
+    const QDeadlineTimer callDeadline = deadline();
+    runOnIoThread([this, message, call, onReply, onCanceled, timeout, callDeadline]() {
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, const_cast<RegistryPrivate*>(this));
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [this, message, onReply, onCanceled, timeout, callDeadline](QDBusPendingCallWatcher *watcher) {
+            watcher->deleteLater();
+            const QDBusMessage reply = watcher->reply();
+            if (directConnectionFailed(message.service(), reply)) {
+                QObject::disconnect(watcher, &QObject::destroyed, nullptr, nullptr);
+                closeDirectConnection(message.service(), true);
+                // Sent again under the timeout and deadline of the first call.
+                RegistryPrivate *self = const_cast<RegistryPrivate*>(this);
+                const QDeadlineTimer ioDeadline = deadline();
+                self->setDeadline(callDeadline);
+                const QDBusPendingCall retry = guardedAsyncCall(message, timeout);
+                self->setDeadline(ioDeadline);
+                watchReply(message, retry, onReply, onCanceled, timeout);
+                return;
+            }
+            onReply(reply);
+        });
+        // Do not leave anyone waiting when the registry goes away before the reply arrived.
+        QObject::connect(watcher, &QObject::destroyed, onCanceled);
+    });
+}
+
+QDBusConnection RegistryPrivate::connectionFor(const QString &service) const
+{
+    // conn.connection() may still wait for the address of the bus, call it unlocked.
+    QMutexLocker locker(&m_lock);
+    if (!m_directConnectionsEnabled || service.isEmpty() || m_busOnlyServices.contains(service)
+            || m_resolvingServices.contains(service) || service == QLatin1String("org.a11y.atspi.Registry")) {
+        locker.unlock();
+        return conn.connection(service);
+    }
+
+    const auto it = m_directConnections.constFind(service);
+    if (it == m_directConnections.constEnd()) {
+        m_resolvingServices.insert(service);
+        locker.unlock();
+        openDirectConnection(service);
+        return conn.connection(service);
+    }
+    if (it->isConnected())
+        return it.value();
+    locker.unlock();
+    closeDirectConnection(service, true);
+    return conn.connection(service);
+}
+
+bool RegistryPrivate::orderedWithEvents(const QString &service) const
+{
+    // Pooled and direct connections have their own queue, only the bus connection is shared with the events.
+    return connectionFor(service).name() == conn.connection().name();
+}
+
+void RegistryPrivate::openDirectConnection(const QString &service) const
+{
+    // Asked through the bus, with the timeouts of the calls to the application.
+    const QDBusMessage message = CallDescriptors::methodCall(service, QLatin1String(ATSPI_DBUS_PATH_ROOT), CallDescriptors::GetApplicationBusAddress);
+    const QDBusPendingCall call = conn.connection(service).asyncCall(message, callTimeout(message, 500));
+    runOnIoThread([this, service, call]() {
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, const_cast<RegistryPrivate*>(this));
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [this, service](QDBusPendingCallWatcher *watcher) {
+            watcher->deleteLater();
+            const QDBusPendingReply<QString> reply = *watcher;
+            QDBusConnection connection(QString());
+            const QString name = QStringLiteral("qaccessibilityclient-%1-%2").arg(quintptr(this)).arg(service);
+            if (reply.isValid() && !reply.value().isEmpty()) {
+                connection = QDBusConnection::connectToPeer(reply.value(), name);
+                if (!connection.isConnected()) {
+                    qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Could not connect directly to" << service << connection.lastError().message();
+                    QDBusConnection::disconnectFromPeer(name);
+                }
+            }
+
+            QMutexLocker locker(&m_lock);
+            // The service left or direct connections got disabled meanwhile.
+            if (!m_resolvingServices.remove(service)) {
+                if (connection.isConnected())
+                    QDBusConnection::disconnectFromPeer(name);
+                return;
+            }
+            if (connection.isConnected())
+                m_directConnections.insert(service, connection);
+            else
+                m_busOnlyServices.insert(service);
+        });
+    });
+}
+
+bool RegistryPrivate::directConnectionFailed(const QString &service, const QDBusMessage &reply) const
+{
+    if (reply.type() != QDBusMessage::ErrorMessage)
+        return false;
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_directConnections.contains(service))
+            return false;
+    }
+    const QDBusError::ErrorType error = QDBusError(reply).type();
+    return error == QDBusError::Disconnected || error == QDBusError::NoServer;
+}
+
+void RegistryPrivate::closeDirectConnection(const QString &service, bool fallBack) const
+{
+    QMutexLocker locker(&m_lock);
+    const QDBusConnection connection = m_directConnections.take(service);
+    if (!connection.name().isEmpty())
+        QDBusConnection::disconnectFromPeer(connection.name());
+    if (fallBack)
+        m_busOnlyServices.insert(service);
+}
+
+void RegistryPrivate::closeDirectConnections()
+{
+    QMutexLocker locker(&m_lock);
+    const QStringList services = m_directConnections.keys();
+    for (const QString &service : services)
+        closeDirectConnection(service, false);
+    m_busOnlyServices.clear();
+    m_resolvingServices.clear();
+}
+
+void RegistryPrivate::watchResponsiveness(const QString &service, const QDBusPendingCall &call) const
+{
+    {
+        QMutexLocker locker(&m_lock);
+        if (m_unresponsiveThreshold <= 0 || service.isEmpty())
+            return;
+    }
+    // The deadline belongs to the calling thread, the reply is looked at on the I/O thread.
+    const QDeadlineTimer callDeadline = deadline();
+    runOnIoThread([this, service, call, callDeadline]() {
+        QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, const_cast<RegistryPrivate*>(this));
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [this, service, callDeadline](QDBusPendingCallWatcher *watcher) {
+            watcher->deleteLater();
+            recordReply(service, watcher->reply(), callDeadline);
+        });
+    });
+}
+
+void RegistryPrivate::recordReply(const QString &service, const QDBusMessage &reply, const QDeadlineTimer &callDeadline) const
+{
+    QMutexLocker locker(&m_lock);
+    if (m_unresponsiveThreshold <= 0 || service.isEmpty())
+        return;
+
+    if (reply.type() != QDBusMessage::ErrorMessage) {
+        m_timeouts.remove(service);
+        return;
+    }
+    if (reply.errorName() == NotRespondingError || reply.errorName() == DeadlineExceededError)
+        return;
+
+    const QDBusError::ErrorType error = QDBusError(reply).type();
+    if (error != QDBusError::NoReply && error != QDBusError::Timeout && error != QDBusError::TimedOut) {
+        // Anything else is an answer too.
+        m_timeouts.remove(service);
+        return;
+    }
+    // The call was cut short by a CallDeadline, that says little about the application.
+    if (callDeadline.hasExpired())
+        return;
+    if (++m_timeouts[service] >= m_unresponsiveThreshold && !m_unresponsive.contains(service)) {
+        locker.unlock();
+        const_cast<RegistryPrivate*>(this)->setResponding(service, false);
+    }
+}
+
+void RegistryPrivate::recordSignatureVariant(const QString &service, const QString &signature) const
+{
+    QMutexLocker locker(&m_lock);
+    QStringList &signatures = m_signatureVariants[service];
+    if (signatures.contains(signature))
+        return;
+    qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Found old api replying with" << signature << "in" << service;
+    signatures.append(signature);
+}
+
+void RegistryPrivate::setResponding(const QString &service, bool responding)
+{
+    QMutexLocker locker(&m_lock);
+    m_timeouts.remove(service);
+    if (responding) {
+        if (!m_unresponsive.remove(service))
+            return;
+    } else {
+        if (m_unresponsive.contains(service))
+            return;
+        qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << "Application not responding:" << service;
+        m_unresponsive.insert(service);
+        const int interval = m_unresponsiveProbeInterval;
+        runOnIoThread([this, service, interval]() {
+            QTimer::singleShot(interval, this, [this, service]() { probeService(service); });
+        });
+    }
+    locker.unlock();
+    Q_EMIT q->applicationRespondingChanged(accessibleFromPath(service, QLatin1String(ATSPI_DBUS_PATH_ROOT)), responding);
+}
+
+void RegistryPrivate::probeService(const QString &service)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_unresponsive.contains(service))
+            return;
+    }
+
+    // Calls keep failing right away until the application answers. Peer.Ping
+    // would not do, the bus library of the application answers it on its own.
+    const QDBusMessage probe = CallDescriptors::methodCall(service, QLatin1String(ATSPI_DBUS_PATH_ROOT), CallDescriptors::GetRole);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(connectionFor(service).asyncCall(probe, 1000), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, service](QDBusPendingCallWatcher *watcher) {
+        watcher->deleteLater();
+        QMutexLocker locker(&m_lock);
+        if (!m_unresponsive.contains(service))
+            return;
+        const int interval = m_unresponsiveProbeInterval;
+        locker.unlock();
+        const QDBusError::ErrorType error = watcher->isError() ? watcher->error().type() : QDBusError::NoError;
+        if (error == QDBusError::NoReply || error == QDBusError::Timeout || error == QDBusError::TimedOut)
+            QTimer::singleShot(interval, this, [this, service]() { probeService(service); });
+        else
+            setResponding(service, true);
+    });
+}
+
+template<typename T>
+QFuture<T> RegistryPrivate::readyFuture(const T &value)
+{
+    QFutureInterface<T> interface;
+    interface.reportStarted();
+    interface.reportResult(value);
+    interface.reportFinished();
+    return interface.future();
+}
+
+template<typename T>
+QFuture<T> RegistryPrivate::asyncCall(const QDBusMessage &message, const std::function<T(const QDBusMessage &)> &handleReply, int timeout) const
+{
+    QFutureInterface<T> interface;
+    interface.reportStarted();
+    const QFuture<T> future = interface.future();
+
+    watchReply(message, sharedAsyncCall(message, timeout), [interface, handleReply](const QDBusMessage &reply) mutable {
+        interface.reportResult(handleReply(reply));
+        interface.reportFinished();
+    }, [interface]() mutable {
+        if (!interface.isFinished()) {
+            interface.reportCanceled();
+            interface.reportFinished();
+        }
+    }, timeout);
+    return future;
+}
+
+template<typename T>
+QFuture<T> RegistryPrivate::cachedAccessiblePropertyAsync(const AccessibleObject &object, ObjectCache::Property property, const QString &name) const
+{
+    if (const LockedCache objectCache = cache()) {
+        const QVariant cachedValue = objectCache->property(object, property);
+        if (cachedValue.isValid())
+            return readyFuture(cachedValue.value<T>());
+    }
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    const QDBusMessage message = propertyMessage(object.d->service, object.d->path, CallDescriptors::name(CallDescriptors::AccessibleInterface), name);
+    // The timeout of the blocking getters, so that both share a pending call.
+    return asyncCall<T>(message, [this, object, stamp, property](const QDBusMessage &reply) {
+        return accessiblePropertyFromReply(object, stamp, property, reply).template value<T>();
+    }, 500);
+}
+
+QFuture<QString> RegistryPrivate::nameAsync(const AccessibleObject &object) const
+{
+    if (!object.isValid())
+        return readyFuture(QString());
+    return cachedAccessiblePropertyAsync<QString>(object, ObjectCache::Name, CallDescriptors::name(CallDescriptors::NameProperty));
+}
+
+QFuture<QString> RegistryPrivate::descriptionAsync(const AccessibleObject &object) const
+{
+    if (!object.isValid())
+        return readyFuture(QString());
+    return cachedAccessiblePropertyAsync<QString>(object, ObjectCache::Description, CallDescriptors::name(CallDescriptors::DescriptionProperty));
+}
+
+QFuture<AccessibleObject::Role> RegistryPrivate::roleAsync(const AccessibleObject &object) const
+{
+    if (!object.isValid())
+        return readyFuture(AccessibleObject::NoRole);
+
+    if (const LockedCache objectCache = cache()) {
+        const QVariant cachedValue = objectCache->property(object, ObjectCache::Role);
+        if (cachedValue.isValid())
+            return readyFuture(static_cast<AccessibleObject::Role>(cachedValue.toInt()));
+    }
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    const QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetRole);
+    return asyncCall<AccessibleObject::Role>(message, [this, object, stamp](const QDBusMessage &reply) {
+        return roleFromReply(object, stamp, reply);
+    });
+}
+
+QFuture<int> RegistryPrivate::childCountAsync(const AccessibleObject &object) const
+{
+    return cachedAccessiblePropertyAsync<int>(object, ObjectCache::ChildCount, CallDescriptors::name(CallDescriptors::ChildCountProperty));
+}
+
+QFuture<AccessibleObject> RegistryPrivate::parentAccessibleAsync(const AccessibleObject &object) const
+{
+    QVariant cachedValue;
+    if (const LockedCache objectCache = cache())
+        cachedValue = objectCache->property(object, ObjectCache::Parent);
+    if (cachedValue.isValid())
+        return readyFuture(parentFromReference(object, cachedValue.value<QSpiObjectReference>()));
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    const QDBusMessage message = propertyMessage(object.d->service, object.d->path, CallDescriptors::name(CallDescriptors::AccessibleInterface), CallDescriptors::name(CallDescriptors::ParentProperty));
+    return asyncCall<AccessibleObject>(message, [this, object, stamp](const QDBusMessage &reply) {
+        return parentFromReply(object, stamp, reply);
+    }, 500);
+}
+
+QFuture<QList<AccessibleObject> > RegistryPrivate::childrenAsync(const AccessibleObject &object) const
+{
+    QMutexLocker locker(&m_lock);
+    QVector<ObjectHandle> handles;
+    if (m_cache && cache()->children(object, handles)) {
+        QList<AccessibleObject> accs;
+        accs.reserve(handles.size());
+        for (ObjectHandle handle : std::as_const(handles))
+            accs.append(accessibleFromHandle(handle));
+        return readyFuture(accs);
+    }
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    locker.unlock();
+
+    const bool ordered = orderedWithEvents(object.d->service);
+    const QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetChildren);
+    return asyncCall<QList<AccessibleObject> >(message, [this, object, stamp, ordered](const QDBusMessage &reply) {
+        return childrenFromReply(object, stamp, ordered, reply);
+    }, 500);
+}
+
+QFuture<QRect> RegistryPrivate::boundingRectAsync(const AccessibleObject &object) const
+{
+    {
+        QRect extents;
+        const LockedCache objectCache = cache();
+        if (objectCache && objectCache->extents(object, extents))
+            return readyFuture(extents);
+    }
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetExtents);
+    message.setArguments(QVariantList() << quint32(ATSPI_COORD_TYPE_SCREEN));
+    return asyncCall<QRect>(message, [this, object, stamp](const QDBusMessage &reply) {
+        return extentsFromReply(object, stamp, reply);
+    });
+}
+
+QFuture<AccessibleObject::Interfaces> RegistryPrivate::supportedInterfacesAsync(const AccessibleObject &object) const
+{
+    if (const LockedCache objectCache = cache()) {
+        const AccessibleObject::Interfaces interfaces = objectCache->interfaces(object);
+        if (!(interfaces & AccessibleObject::InvalidInterface))
+            return readyFuture(interfaces);
+    }
+
+    const ObjectCache::Stamp stamp = cacheStamp(object);
+    const QDBusMessage message = CallDescriptors::methodCall(object.d->service, object.d->path, CallDescriptors::GetInterfaces);
+    return asyncCall<AccessibleObject::Interfaces>(message, [this, object, stamp](const QDBusMessage &reply) {
+        return interfacesFromReply(object, stamp, reply);
+    });
+}
+
 AccessibleObject RegistryPrivate::accessibleFromPath(const QString &service, const QString &path) const
 {
     return AccessibleObject(const_cast<RegistryPrivate*>(this), service, path);
@@ -1309,89 +2624,208 @@ AccessibleObject RegistryPrivate::accessibleFromContext() const
     return accessibleFromPath(QDBusContext::message().service(), QDBusContext::message().path());
 }
 
+AccessibleObject RegistryPrivate::cachedFromContext() const
+{
+    QMutexLocker locker(&m_lock);
+    if (!m_cache)
+        return AccessibleObject();
+    const ObjectHandle handle = m_handles.find(QDBusContext::message().service(), QDBusContext::message().path());
+    const QSharedPointer<AccessibleObjectPrivate> objectPrivate = handle ? m_cache->peek(handle) : QSharedPointer<AccessibleObjectPrivate>();
+    return objectPrivate ? AccessibleObject(objectPrivate) : AccessibleObject();
+}
+
+AccessibleObject RegistryPrivate::accessibleFromHandle(ObjectHandle handle) const
+{
+    QMutexLocker locker(&m_lock);
+    // Handles of services that left the bus resolve to empty strings.
+    if (m_handles.path(handle).isEmpty())
+        return AccessibleObject();
+    return AccessibleObject(const_cast<RegistryPrivate*>(this), handle);
+}
+
 void RegistryPrivate::slotWindowCreate(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &)
 {
-    Q_EMIT q->windowCreated(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowCreated(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowDestroy(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowDestroyed(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowDestroyed(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowClose(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowClosed(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowClosed(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowReparent(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowReparented(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowReparented(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowMinimize(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowMinimized(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowMinimized(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowMaximize(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowMaximized(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowMaximized(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowRestore(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowRestored(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowRestored(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowActivate(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowActivated(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowActivated(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowDeactivate(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowDeactivated(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowDeactivated(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowDesktopCreate(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowDesktopCreated(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowDesktopCreated(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowDesktopDestroy(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowDesktopDestroyed(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowDesktopDestroyed(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowRaise(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowRaised(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowRaised(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowLower(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowLowered(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowLowered(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowMove(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowMoved(accessibleFromContext());
+    cleanExtents();
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowMoved(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowResize(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowResized(accessibleFromContext());
+    cleanExtents();
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowResized(accessibleFromContext());
+}
+
+void RegistryPrivate::slotBoundsChanged(const QString &/*state*/, int /*detail1*/, int /*detail2*/, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &/*reference*/)
+{
+    // Children move along with their parent, ancestors may grow or shrink.
+    const AccessibleObject cached = cachedFromContext();
+    cleanExtents(cached);
+    if (subscribed(Registry::BoundsChanged))
+        Q_EMIT q->boundsChanged(cached.isValid() ? cached : accessibleFromContext());
+}
+
+void RegistryPrivate::cleanExtents()
+{
+    const LockedCache objectCache = cache();
+    if (!objectCache)
+        return;
+    const quint32 serviceId = m_handles.findService(QDBusContext::message().service());
+    if (serviceId)
+        objectCache->cleanExtents(serviceId);
+}
+
+void RegistryPrivate::cleanExtents(const AccessibleObject &object)
+{
+    if (!object.isValid()) {
+        cleanExtents();
+        return;
+    }
+    QMutexLocker locker(&m_lock);
+    if (!m_cache)
+        return;
+
+    // Walks the cached parents up to the application and the cached child
+    // lists down to the leaves. A gap means there may be cached objects that
+    // cannot be reached, those are dropped together with the whole application.
+    bool complete = true;
+    QSet<ObjectHandle> visited;
+    QSharedPointer<AccessibleObjectPrivate> ancestor = object.d;
+    while (ancestor && !visited.contains(ancestor->handle)) {
+        visited.insert(ancestor->handle);
+        m_cache->cleanExtents(AccessibleObject(ancestor));
+        if (ancestor->path == QLatin1String(ATSPI_DBUS_PATH_ROOT))
+            break;
+        const QVariant parent = ancestor->cachedProperties.value(ObjectCache::Parent);
+        if (!parent.isValid()) {
+            complete = false;
+            break;
+        }
+        const QSpiObjectReference reference = parent.value<QSpiObjectReference>();
+        if (reference.path.path() == QLatin1String(ATSPI_DBUS_PATH_NULL))
+            break;
+        const ObjectHandle handle = m_handles.find(reference.service, reference.path.path());
+        ancestor = handle ? m_cache->peek(handle) : QSharedPointer<AccessibleObjectPrivate>();
+    }
+
+    QVector<QSharedPointer<AccessibleObjectPrivate> > pending;
+    pending.append(object.d);
+    while (complete && !pending.isEmpty()) {
+        const QSharedPointer<AccessibleObjectPrivate> objectPrivate = pending.takeLast();
+        if (!objectPrivate->childrenCached) {
+            // Leaves are fine, of anything else the children may be cached.
+            const QVariant childCount = objectPrivate->cachedProperties.value(ObjectCache::ChildCount);
+            complete = childCount.isValid() && childCount.toInt() == 0;
+            continue;
+        }
+        for (ObjectHandle child : std::as_const(objectPrivate->cachedChildren)) {
+            if (visited.contains(child))
+                continue;
+            visited.insert(child);
+            const QSharedPointer<AccessibleObjectPrivate> childPrivate = m_cache->peek(child);
+            if (!childPrivate) {
+                // Its own children may still be alive.
+                complete = false;
+                break;
+            }
+            m_cache->cleanExtents(AccessibleObject(childPrivate));
+            pending.append(childPrivate);
+        }
+    }
+
+    if (!complete)
+        m_cache->cleanExtents(ObjectHandles::serviceId(object.d->handle));
 }
 
 void RegistryPrivate::slotWindowShade(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowShaded(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowShaded(accessibleFromContext());
 }
 
 void RegistryPrivate::slotWindowUnshade(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference)
 {
-    Q_EMIT q->windowUnshaded(accessibleFromContext());
+    if (subscribed(Registry::Window))
+        Q_EMIT q->windowUnshaded(accessibleFromContext());
 }
 
 void RegistryPrivate::slotPropertyChange(const QString &property, int detail1, int detail2, const QDBusVariant &args, const QSpiObjectReference &reference)
@@ -1399,10 +2833,37 @@ void RegistryPrivate::slotPropertyChange(const QString &property, int detail1, i
 #ifdef ATSPI_DEBUG
     qDebug() << Q_FUNC_INFO << property << detail1 << detail2 << args.variant() << reference.path.path();
 #endif
+    // Objects that are not cached have nothing to invalidate.
+    const AccessibleObject cached = cachedFromContext();
     if (property == QLatin1String("accessible-name")) {
-        Q_EMIT q->accessibleNameChanged(accessibleFromContext());
+        if (cached.isValid()) {
+            if (const LockedCache objectCache = cache())
+                objectCache->cleanProperty(cached, ObjectCache::Name);
+        }
+        if (subscribed(Registry::PropertyChanged))
+            Q_EMIT q->accessibleNameChanged(cached.isValid() ? cached : accessibleFromContext());
     } else if (property == QLatin1String("accessible-description")) {
-        Q_EMIT q->accessibleDescriptionChanged(accessibleFromContext());
+        if (cached.isValid()) {
+            if (const LockedCache objectCache = cache())
+                objectCache->cleanProperty(cached, ObjectCache::Description);
+        }
+        if (subscribed(Registry::PropertyChanged))
+            Q_EMIT q->accessibleDescriptionChanged(cached.isValid() ? cached : accessibleFromContext());
+    } else if (property == QLatin1String("accessible-parent")) {
+        if (cached.isValid()) {
+            if (const LockedCache objectCache = cache()) {
+                objectCache->cleanProperty(cached, ObjectCache::Parent);
+                objectCache->cleanProperty(cached, ObjectCache::IndexInParent);
+            }
+        }
+    } else if (property == QLatin1String("accessible-role")) {
+        if (cached.isValid()) {
+            if (const LockedCache objectCache = cache()) {
+                objectCache->cleanProperty(cached, ObjectCache::Role);
+                objectCache->cleanProperty(cached, ObjectCache::RoleName);
+                objectCache->cleanProperty(cached, ObjectCache::LocalizedRoleName);
+            }
+        }
     }
 }
 
@@ -1410,25 +2871,37 @@ void RegistryPrivate::slotStateChanged(const QString &state, int detail1, int de
 {
     //qDebug() << Q_FUNC_INFO << state << detail1 << detail2 << reference.service << reference.path.path() << QDBusContext::message();
 
+    // Objects that are not cached have nothing to invalidate.
+    const AccessibleObject cached = cachedFromContext();
     if (state == QLatin1String("defunct") && (detail1 == 1)) {
-        QSpiObjectReference removed;
-        removed.service = QDBusContext::message().service();
-        removed.path = QDBusObjectPath(QDBusContext::message().path());
-        removeAccessibleObject(removed);
+        if (cached.isValid()) {
+            if (const LockedCache objectCache = cache())
+                objectCache->remove(cached.d->handle);
+            cached.d->setDefunct();
+        }
+        // The cache listens to state changes also when the user does not.
+        if (subscribed(Registry::StateChanged))
+            Q_EMIT q->removed(cached.isValid() ? cached : accessibleFromContext());
         return;
     }
 
-    AccessibleObject accessible = accessibleFromContext();
-    if (m_cache) {
-        m_cache->cleanState(accessible);
+    if (cached.isValid()) {
+        if (const LockedCache objectCache = cache())
+            objectCache->cleanState(cached);
     }
 
-    if (state == QLatin1String("focused") && (detail1 == 1) &&
-            (q->subscribedEventListeners().testFlag(Registry::Focus))) {
+    const bool focusChanged = state == QLatin1String("focused") && (detail1 == 1) &&
+            q->subscribedEventListeners().testFlag(Registry::Focus);
+    const bool stateChanged = q->subscribedEventListeners().testFlag(Registry::StateChanged);
+    if (!focusChanged && !stateChanged)
+        return;
+
+    const AccessibleObject accessible = cached.isValid() ? cached : accessibleFromContext();
+    if (focusChanged) {
         Q_EMIT q->focusChanged(accessible);
     }
 
-    if (q->subscribedEventListeners().testFlag(Registry::StateChanged)) {
+    if (stateChanged) {
         Q_EMIT q->stateChanged(accessible, state, detail1 == 1);
     }
 }
@@ -1441,12 +2914,11 @@ void RegistryPrivate::slotStateChanged(const QString &state, int detail1, int de
 bool RegistryPrivate::removeAccessibleObject(const QAccessibleClient::AccessibleObject &accessible)
 {
     Q_ASSERT(accessible.isValid());
-    if (m_cache) {
-        const QString id = accessible.id();
-        if (m_cache->remove(id)) {
-            Q_EMIT q->removed(accessible);
-        }
-    } else {
+    // Without a cache every object counts as removed.
+    bool removed = true;
+    if (const LockedCache objectCache = cache())
+        removed = objectCache->remove(accessible.d->handle);
+    if (removed) {
         Q_EMIT q->removed(accessible);
     }
     if (accessible.d)
@@ -1454,20 +2926,20 @@ bool RegistryPrivate::removeAccessibleObject(const QAccessibleClient::Accessible
     return true;
 }
 
-bool RegistryPrivate::removeAccessibleObject(const QAccessibleClient::QSpiObjectReference &reference)
-{
-    QAccessibleClient::AccessibleObject acc = accessibleFromReference(reference);
-    if (acc.isValid()) {
-        if (removeAccessibleObject(acc))
-            return true;
-    }
-    return false;
-}
-
 void RegistryPrivate::slotChildrenChanged(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference)
 {
 //    qDebug() << Q_FUNC_INFO << state << detail1 << detail2 << args.variant() << reference.path.path();
-    QAccessibleClient::AccessibleObject parentAccessible = accessibleFromContext();
+    const AccessibleObject cached = cachedFromContext();
+    if (cached.isValid()) {
+        updateCachedChildren(cached, state, detail1, args);
+    }
+    // the layout of the siblings and ancestors may change as well
+    cleanExtents(cached);
+
+    if (!subscribed(Registry::ChildrenChanged))
+        return;
+
+    const AccessibleObject parentAccessible = cached.isValid() ? cached : accessibleFromContext();
     if (!parentAccessible.isValid()) {
         qCWarning(LIBQACCESSIBILITYCLIENT_LOG) << Q_FUNC_INFO << "Children change with invalid parent." << reference.path.path();
         return;
@@ -1483,6 +2955,94 @@ void RegistryPrivate::slotChildrenChanged(const QString &state, int detail1, int
     }
 }
 
+void RegistryPrivate::updateCachedChildren(const AccessibleObject &parent, const QString &state, int index, const QDBusVariant &args)
+{
+    const LockedCache objectCache = cache();
+    if (!objectCache)
+        return;
+    QVector<ObjectHandle> children;
+    if (!objectCache->children(parent, children)) {
+        objectCache->cleanProperty(parent, ObjectCache::ChildCount);
+        return;
+    }
+    if (!parent.d->childrenOrdered) {
+        // The list may already contain this change or not, fetch it again.
+        objectCache->cleanChildren(parent);
+        objectCache->cleanProperty(parent, ObjectCache::ChildCount);
+        for (ObjectHandle oldChild : std::as_const(children))
+            setCachedParent(oldChild, parent, -1);
+        return;
+    }
+
+    QSpiObjectReference reference;
+    const QVariant variant = args.variant();
+    if (variant.userType() == qMetaTypeId<QDBusArgument>())
+        variant.value<QDBusArgument>() >> reference;
+    if (reference.service.isEmpty())
+        reference.service = parent.d->service;
+    // Only added children are interned, a removed one is either known or not in the list.
+    ObjectHandle child = 0;
+    if (!reference.path.path().isEmpty()) {
+        child = state == QLatin1String("add") ? m_handles.handle(reference.service, reference.path.path())
+                                              : m_handles.find(reference.service, reference.path.path());
+    }
+
+    // The children may have been fetched after the change already, do not apply it twice.
+    const QVector<ObjectHandle> oldChildren = children;
+    bool patched = false;
+    if (child && state == QLatin1String("add") && index >= 0 && index <= children.size()) {
+        if (index == children.size() || children.at(index) != child)
+            children.insert(index, child);
+        patched = true;
+    } else if (child && state == QLatin1String("remove") && index >= 0) {
+        if (index < children.size() && children.at(index) == child) {
+            children.remove(index);
+            setCachedParent(child, parent, -1);
+            patched = true;
+        } else {
+            patched = !children.contains(child);
+        }
+    }
+
+    if (patched) {
+        objectCache->changed(parent);
+        objectCache->setChildren(parent, children, true);
+        objectCache->setProperty(parent, ObjectCache::ChildCount, children.size());
+        // Only the siblings behind the change moved.
+        for (int i = qMax(index, 0); i < children.size(); ++i)
+            setCachedParent(children.at(i), parent, i);
+    } else {
+        objectCache->cleanChildren(parent);
+        objectCache->cleanProperty(parent, ObjectCache::ChildCount);
+        for (ObjectHandle oldChild : oldChildren)
+            setCachedParent(oldChild, parent, -1);
+    }
+}
+
+void RegistryPrivate::setCachedParent(ObjectHandle child, const AccessibleObject &parent, int index)
+{
+    const LockedCache objectCache = cache();
+    if (!objectCache)
+        return;
+    const QSharedPointer<AccessibleObjectPrivate> childPrivate = objectCache->peek(child);
+    if (!childPrivate)
+        return;
+
+    const AccessibleObject object(childPrivate);
+    if (index < 0) {
+        objectCache->cleanProperty(object, ObjectCache::Parent);
+        objectCache->cleanProperty(object, ObjectCache::IndexInParent);
+        return;
+    }
+
+    QSpiObjectReference parentReference;
+    parentReference.service = parent.d->service;
+    parentReference.path = QDBusObjectPath(parent.d->path);
+    objectCache->changed(object);
+    objectCache->setProperty(object, ObjectCache::Parent, QVariant::fromValue(parentReference));
+    objectCache->setProperty(object, ObjectCache::IndexInParent, index);
+}
+
 void RegistryPrivate::slotVisibleDataChanged(const QString &/*state*/, int /*detail1*/, int /*detail2*/, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference)
 {
     Q_EMIT q->visibleDataChanged(accessibleFromContext());
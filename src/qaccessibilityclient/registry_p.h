@@ -10,11 +10,18 @@
 #include <atspi/atspi-constants.h>
 
 #include <QObject>
+#include <QFuture>
 #include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QThreadStorage>
 #include <QDBusContext>
 #include <QSignalMapper>
 #include <QSharedPointer>
 
+#include <functional>
+
 #include "atspi/dbusconnection.h"
 #include "qaccessibilityclient/registry.h"
 #include "qaccessibilityclient/accessibleobject.h"
@@ -28,6 +35,46 @@ namespace QAccessibleClient {
 
 class DBusConnection;
 
+/**
+    Identifies a read-only call for sharing it, see RegistryPrivate::sharedAsyncCall().
+    The arguments are shared with the message, only compared on hash collisions.
+ */
+struct SharedCallKey
+{
+    ObjectHandle handle = 0;
+    int call = 0; ///< CallDescriptors::Call
+    int timeout = -1;
+    uint argumentsHash = 0;
+    QList<QVariant> arguments;
+
+    bool operator==(const SharedCallKey &other) const
+    {
+        return handle == other.handle && call == other.call && timeout == other.timeout
+                && argumentsHash == other.argumentsHash && arguments == other.arguments;
+    }
+};
+
+inline uint qHash(const SharedCallKey &key, uint seed = 0)
+{
+    return qHash(key.handle, seed) ^ uint(key.call) ^ (uint(key.timeout) << 8) ^ key.argumentsHash;
+}
+
+/**
+    A call in flight that identical calls join instead of being sent again.
+ */
+struct SharedCall
+{
+    QDBusPendingCall call;
+    // Of the object when the call was sent, calls sent before a change are not joined.
+    ObjectCache::Stamp stamp;
+};
+
+/**
+    Lives on a thread of its own, the I/O thread, which receives the events
+    and decodes the replies to non-blocking calls. Blocking calls are made
+    from the thread asking and can come from any thread, the state they
+    share is guarded by m_lock.
+ */
 class RegistryPrivate :public QObject, public QDBusContext
 {
     Q_OBJECT
@@ -47,6 +94,18 @@ public:
 
     void subscribeEventListeners(const Registry::EventListeners & listeners);
     Registry::EventListeners eventListeners() const;
+    /**
+        Listeners the library needs for itself, for example to keep the cache
+        coherent. They are registered next to the ones of the user without
+        emitting any of the user visible signals.
+     */
+    void setInternalEventListeners(const Registry::EventListeners &listeners);
+    /// Events the cache needs to invalidate its values.
+    static Registry::EventListeners cacheEventListeners()
+    {
+        return Registry::StateChanged | Registry::PropertyChanged | Registry::ChildrenChanged
+                | Registry::Window | Registry::BoundsChanged;
+    }
 
     QString accessibleId(const AccessibleObject &object) const;
     QString name(const AccessibleObject &object) const;
@@ -96,6 +155,8 @@ public:
     QRect imageRect(const AccessibleObject &object) const;
 
     QVector< QSharedPointer<QAction> > actions(const AccessibleObject &object);
+    /// Sends DoAction without waiting for the reply, used by the QActions returned by actions().
+    void doAction(const QString &service, const QString &path, int index) const;
 
     QList<AccessibleObject> topLevelAccessibles() const;
     AccessibleObject parentAccessible(const AccessibleObject &object) const;
@@ -105,6 +166,28 @@ public:
     AccessibleObject child(const AccessibleObject &object, int index) const;
     QList<AccessibleObject> children(const AccessibleObject &object) const;
 
+    /**
+        Non-blocking variants of the getters above. Values that are cached
+        are returned as finished futures, everything else is fetched with
+        asyncCall() so that calls to different applications run in parallel.
+     */
+    QFuture<QString> nameAsync(const AccessibleObject &object) const;
+    QFuture<QString> descriptionAsync(const AccessibleObject &object) const;
+    QFuture<AccessibleObject::Role> roleAsync(const AccessibleObject &object) const;
+    QFuture<int> childCountAsync(const AccessibleObject &object) const;
+    QFuture<AccessibleObject> parentAccessibleAsync(const AccessibleObject &object) const;
+    QFuture<QList<AccessibleObject> > childrenAsync(const AccessibleObject &object) const;
+    QFuture<QRect> boundingRectAsync(const AccessibleObject &object) const;
+    QFuture<AccessibleObject::Interfaces> supportedInterfacesAsync(const AccessibleObject &object) const;
+
+    AccessibleObjectInfo info(const AccessibleObject &object) const;
+    static QString stateString(quint64 state, AccessibleObject::Role role);
+
+    QList<AccessibleObject> populateCache(const AccessibleObject &application);
+    void mirrorApplication(const AccessibleObject &application);
+    void stopMirroring(const QString &service);
+    void removeService(const QString &service);
+
     static QString ACCESSIBLE_OBJECT_SCHEME_STRING;
 
 private Q_SLOTS:
@@ -137,7 +220,7 @@ private Q_SLOTS:
 
     void slotStateChanged(const QString &state, int detail1, int detail2, const QDBusVariant &/*args*/, const QAccessibleClient::QSpiObjectReference &reference);
     //void slotPropertyChanged(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference);
-    //void slotBoundsChanged(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference);
+    void slotBoundsChanged(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference);
     //void slotLinkSelected(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference);
 
     void slotChildrenChanged(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference);
@@ -153,27 +236,185 @@ private Q_SLOTS:
     //void slotTextAttributesChanged(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference);
     //void slotAttributesChanged(const QString &state, int detail1, int detail2, const QDBusVariant &args, const QAccessibleClient::QSpiObjectReference &reference);
 
-    void actionTriggered(const QString &action);
+    void slotAddAccessible(const QDBusMessage &message);
+    void slotRemoveAccessible(const QDBusMessage &message);
+    void slotNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner);
 
 private:
+    LockedCache cache() const
+    {
+        return LockedCache(m_cache, &m_lock);
+    }
+    /// Runs \a function on the I/O thread, right away if called from there and later otherwise.
+    void runOnIoThread(const std::function<void()> &function) const;
+    bool subscribed(Registry::EventListener listener) const;
+    /// The deadline set by a CallDeadline in the calling thread.
+    QDeadlineTimer deadline() const;
+    void setDeadline(const QDeadlineTimer &deadline);
+
+    void updateEventSubscriptions();
+    AccessibleObject accessibleFromHandle(ObjectHandle handle) const;
+    /**
+        The cached object the signal being delivered is about, invalid if it
+        is not cached. Unlike accessibleFromContext() nothing is interned or
+        created and the cache does not count it as used.
+     */
+    AccessibleObject cachedFromContext() const;
     QVariant getProperty ( const QString &service, const QString &path, const QString &interface, const QString &name ) const;
+    static QDBusMessage propertyMessage(const QString &service, const QString &path, const QString &interface, const QString &name);
+    static QVariant propertyFromReply(const QDBusMessage &reply);
+    QVariant cachedAccessibleProperty(const AccessibleObject &object, ObjectCache::Property property, const QString &name) const;
+
+    /**
+        Sends \a message unless an identical call is still waiting for its
+        reply, in which case that call is shared. Only for calls without
+        side effects. Calls with different timeouts, or made while a
+        CallDeadline is set, are not shared.
+     */
+    QDBusPendingCall sharedAsyncCall(const QDBusMessage &message, int timeout = -1) const;
+    /// Blocking variant of sharedAsyncCall()
+    QDBusMessage sharedCall(const QDBusMessage &message, int timeout = -1) const;
+    /// Returns false if \a message cannot be shared. Expects the lock to be held.
+    bool sharedCallKey(const QDBusMessage &message, int effectiveTimeout, SharedCallKey &key) const;
+    /**
+        Sends \a message, or fails right away with NotResponding when its
+        service did not answer the last calls.
+     */
+    QDBusPendingCall guardedAsyncCall(const QDBusMessage &message, int timeout = -1) const;
+    /// guardedAsyncCall() with the timeout already looked up by callTimeout()
+    QDBusPendingCall sendGuardedCall(const QDBusMessage &message, int effectiveTimeout) const;
+    QDBusMessage guardedCall(const QDBusMessage &message, int timeout = -1) const;
+    /// The timeout for \a message, \a timeout unless set otherwise or cut by a CallDeadline
+    int callTimeout(const QDBusMessage &message, int timeout) const;
+    /**
+        Waits for \a call sent with \a message. Sends \a message again through
+        the bus if the direct connection failed.
+     */
+    QDBusMessage waitForReply(const QDBusMessage &message, QDBusPendingCall call, int timeout = -1) const;
+    /// Non-blocking variant of waitForReply(), \a onCanceled is called if the registry goes away first.
+    void watchReply(const QDBusMessage &message, const QDBusPendingCall &call,
+                    const std::function<void(const QDBusMessage &)> &onReply, const std::function<void()> &onCanceled,
+                    int timeout = -1) const;
+    // The direct connection to \a service if enabled and available, the bus otherwise.
+    QDBusConnection connectionFor(const QString &service) const;
+    /**
+        Returns whether calls to \a service go over the connection its events
+        arrive on. Only then is a reply known to be in order with the events
+        the application sent before and after it.
+     */
+    bool orderedWithEvents(const QString &service) const;
+    // Asks for the address of \a service in the background and connects to it.
+    void openDirectConnection(const QString &service) const;
+    bool directConnectionFailed(const QString &service, const QDBusMessage &reply) const;
+    void closeDirectConnection(const QString &service, bool fallBack) const;
+    void closeDirectConnections();
+    /**
+        Keeps track of timeouts of \a service with the reply to \a call once it
+        arrives, once per call however many callers share it.
+     */
+    void watchResponsiveness(const QString &service, const QDBusPendingCall &call) const;
+    void recordReply(const QString &service, const QDBusMessage &reply, const QDeadlineTimer &callDeadline) const;
+    // Remembers that \a service uses a legacy reply \a signature, warns the first time.
+    void recordSignatureVariant(const QString &service, const QString &signature) const;
+    void setResponding(const QString &service, bool responding);
+    void probeService(const QString &service);
+
+    /**
+        Sends \a message without blocking. The returned future finishes with the
+        value \a handleReply makes of the reply or error, or is canceled if the
+        registry is deleted before.
+     */
+    template<typename T>
+    QFuture<T> asyncCall(const QDBusMessage &message, const std::function<T(const QDBusMessage &)> &handleReply, int timeout = -1) const;
+    template<typename T>
+    static QFuture<T> readyFuture(const T &value);
+    template<typename T>
+    QFuture<T> cachedAccessiblePropertyAsync(const AccessibleObject &object, ObjectCache::Property property, const QString &name) const;
+
+    // Taken before sending a call whose reply is cached, invalid without cache.
+    ObjectCache::Stamp cacheStamp(const AccessibleObject &object) const;
+    // Shared by the blocking and non-blocking getters, update the cache if \a stamp is still current.
+    QVariant accessiblePropertyFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, ObjectCache::Property property, const QDBusMessage &reply) const;
+    AccessibleObject::Role roleFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &reply) const;
+    QString roleNameFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &reply) const;
+    quint64 stateFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &reply) const;
+    AccessibleObject parentFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &reply) const;
+    AccessibleObject parentFromReference(const AccessibleObject &object, const QSpiObjectReference &reference) const;
+    // \a ordered tells whether the call went over the connection the events arrive on, see orderedWithEvents().
+    QList<AccessibleObject> childrenFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, bool ordered, const QDBusMessage &reply) const;
+    QRect extentsFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &reply) const;
+    AccessibleObject::Interfaces interfacesFromReply(const AccessibleObject &object, const ObjectCache::Stamp &stamp, const QDBusMessage &reply) const;
+    AccessibleObject::Interfaces interfacesFromNames(const QStringList &names) const;
+    AccessibleObject updateCache(const QString &service, const QSpiAccessibleCacheItem &item);
+    // Caches the child lists that the items of a GetItems reply describe completely, \a objects are the items' objects.
+    void cacheChildLists(const QString &service, const QSpiAccessibleCacheArray &items, const QList<AccessibleObject> &objects, bool ordered);
+    void updateCachedChildren(const AccessibleObject &parent, const QString &state, int index, const QDBusVariant &args);
+    void setCachedParent(ObjectHandle child, const AccessibleObject &parent, int index);
+    // Invalidates the extents of the application that sent the current event.
+    void cleanExtents();
+    /**
+        Invalidates the extents of \a object, its cached ancestors and its cached
+        descendants. Falls back to the whole application when the object is not
+        cached or the cache does not tell which of them are cached.
+     */
+    void cleanExtents(const AccessibleObject &object);
     static AccessibleObject::Role atspiRoleToRole(AtspiRole role);
 
+    // Guards the state below that is shared between the threads, never held while waiting for a reply.
+    mutable QRecursiveMutex m_lock;
+    QThread m_ioThread;
     DBusConnection conn;
-    QSignalMapper m_actionMapper;
     Registry *const q;
+    // Listeners requested through Registry::subscribeEventListeners().
     Registry::EventListeners m_subscriptions;
-    Registry::EventListeners m_pendingSubscriptions;
+    Registry::EventListeners m_internalSubscriptions;
+    // Listeners registered on the bus, the union of the ones above. Only used on the I/O thread.
+    Registry::EventListeners m_activeSubscriptions;
+    // org.a11y.Status, read in connectionFetched() and updated by a11yConnectionChanged().
+    bool m_statusFetched = false;
+    bool m_enabled = false;
+    bool m_screenReaderEnabled = false;
+    // Bumped with each change of the values above, see connectionFetched().
+    quint32 m_enabledGeneration = 0;
+    quint32 m_screenReaderEnabledGeneration = 0;
     QHash<QString, AccessibleObject::Interface> interfaceHash;
     QSignalMapper m_eventMapper;
+    ObjectHandles m_handles;
     ObjectCache *m_cache = nullptr;
+    // Objects of mirrored applications by service, kept alive for the cache.
+    QHash<QString, QHash<ObjectHandle, AccessibleObject> > m_mirrors;
+    // Objects of the last populateCache() by service, kept alive for the WeakCache.
+    QHash<QString, QList<AccessibleObject> > m_populated;
+    // Read-only calls waiting for their reply, see sharedAsyncCall().
+    mutable QHash<SharedCallKey, SharedCall> m_sharedCalls;
+    mutable quint64 m_coalescedCalls = 0;
+    // Timeouts in a row by service and the services that are considered not responding.
+    mutable QHash<QString, int> m_timeouts;
+    QSet<QString> m_unresponsive;
+    int m_unresponsiveThreshold = 0;
+    int m_unresponsiveProbeInterval = 5000;
+    // Legacy reply signatures seen by service, see recordSignatureVariant().
+    mutable QHash<QString, QStringList> m_signatureVariants;
+    // Direct connections by service, and the services that are called through the bus.
+    bool m_directConnectionsEnabled = false;
+    mutable QHash<QString, QDBusConnection> m_directConnections;
+    mutable QSet<QString> m_busOnlyServices;
+    // Services whose address is being asked for, called through the bus meanwhile.
+    mutable QSet<QString> m_resolvingServices;
+    // Set by Registry::setCallTimeout(), the default under the empty name.
+    QHash<QString, int> m_callTimeouts;
+    // Set while a CallDeadline exists, per thread.
+    QThreadStorage<QDeadlineTimer> m_deadlines;
+    // Enough for all objects of an application with several thousand widgets.
+    int m_cacheMaxObjects = 16384;
+    qint64 m_cacheMaxBytes = 16 * 1024 * 1024;
 //     typedef QMap<QString, QSharedPointer<AccessibleObjectPrivate> >::Iterator AccessibleObjectsHashIterator;
 //     typedef QMap<QString, QSharedPointer<AccessibleObjectPrivate> >::ConstIterator AccessibleObjectsHashConstIterator;
 //     QMap<QString, QSharedPointer<AccessibleObjectPrivate> > accessibleObjectsHash;
     bool removeAccessibleObject(const QAccessibleClient::AccessibleObject &accessible);
-    bool removeAccessibleObject(const QAccessibleClient::QSpiObjectReference &reference);
 
     friend class Registry;
+    friend class CallDeadline;
     friend class AccessibleObject;
     friend class AccessibleObjectPrivate;
 };
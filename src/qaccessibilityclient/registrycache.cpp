@@ -21,6 +21,21 @@ void RegistryPrivateCacheApi::setCacheType(CacheType type)
     m_registry->setCacheType(static_cast<Registry::CacheType>(type));
 }
 
+void RegistryPrivateCacheApi::setCacheLimits(int maxObjects, qint64 maxBytes)
+{
+    m_registry->setCacheLimits(maxObjects, maxBytes);
+}
+
+int RegistryPrivateCacheApi::cacheMaxObjects() const
+{
+    return m_registry->cacheMaxObjects();
+}
+
+qint64 RegistryPrivateCacheApi::cacheMaxBytes() const
+{
+    return m_registry->cacheMaxBytes();
+}
+
 AccessibleObject RegistryPrivateCacheApi::clientCacheObject(const QString &id) const
 {
     return m_registry->clientCacheObject(id);
@@ -34,3 +49,33 @@ void RegistryPrivateCacheApi::clearClientCache()
 {
     m_registry->clearClientCache();
 }
+
+QList<AccessibleObject> RegistryPrivateCacheApi::populateClientCache(const AccessibleObject &application)
+{
+    return m_registry->populateClientCache(application);
+}
+
+void RegistryPrivateCacheApi::mirrorApplication(const AccessibleObject &application)
+{
+    m_registry->mirrorApplication(application);
+}
+
+void RegistryPrivateCacheApi::stopMirroringApplication(const AccessibleObject &application)
+{
+    m_registry->stopMirroringApplication(application);
+}
+
+CacheStatistics RegistryPrivateCacheApi::cacheStatistics(bool reset)
+{
+    return m_registry->cacheStatistics(reset);
+}
+
+QHash<QString, QStringList> RegistryPrivateCacheApi::signatureVariants() const
+{
+    return m_registry->signatureVariants();
+}
+
+QStringList RegistryPrivateCacheApi::trackedServices() const
+{
+    return m_registry->trackedServices();
+}
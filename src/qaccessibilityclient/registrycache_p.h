@@ -10,10 +10,46 @@
 #include "qaccessibilityclient_export.h"
 #include "accessibleobject.h"
 
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+
 namespace QAccessibleClient {
 
 class Registry;
 
+/**
+    Counters of one cached field.
+ */
+struct CacheFieldStatistics
+{
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 inserts = 0;
+    quint64 evictions = 0; ///< values dropped together with their object
+    quint64 invalidations = 0; ///< values dropped because the application reported a change
+};
+
+/**
+    Snapshot of the client cache returned by RegistryPrivateCacheApi::cacheStatistics().
+ */
+struct CacheStatistics
+{
+    /**
+        Counters by field name, "object" counts the lookups of the objects
+        themselves, "state", "interfaces" and "children" the states,
+        interfaces and child lists and the remaining ones the cached
+        properties like "name" or "role".
+     */
+    QMap<QString, CacheFieldStatistics> fields;
+    int objects = 0;
+    qint64 approximateBytes = 0;
+    /// Calls that shared the reply of an identical call already in flight, counted with and without cache
+    quint64 coalescedCalls = 0;
+    /// Object paths currently interned, they are forgotten once no object or cached child list refers to them
+    int objectPaths = 0;
+};
+
 // Private API. May be gone or changed anytime soon.
 class QACCESSIBILITYCLIENT_EXPORT RegistryPrivateCacheApi
 {
@@ -21,6 +57,7 @@ public:
     enum CacheType {
         NoCache, ///< Disable any caching.
         WeakCache, ///< Cache only objects in use and free them as long as no-one holds a reference to them any longer.
+        StrongCache, ///< Additionally keep the most recently used objects alive within the limits set by setCacheLimits().
     };
 
     explicit RegistryPrivateCacheApi(Registry *registry);
@@ -28,10 +65,62 @@ public:
     CacheType cacheType() const;
     void setCacheType(CacheType type);
 
+    /**
+        Limits the number of objects and the approximate number of bytes
+        the StrongCache keeps alive. The least recently used objects are
+        released first. The defaults of 16384 objects and 16 MiB hold all
+        objects of an application with several thousand widgets.
+     */
+    void setCacheLimits(int maxObjects, qint64 maxBytes);
+    int cacheMaxObjects() const;
+    qint64 cacheMaxBytes() const;
+
     AccessibleObject clientCacheObject(const QString &id) const;
     QStringList clientCacheObjects() const;
     void clearClientCache();
 
+    /**
+        Fetches all objects of the \a application in one call to the
+        org.a11y.atspi.Cache interface and fills the client cache with their
+        parent, child count, interfaces, name, role, description and state.
+
+        The objects stay alive, with the WeakCache too, until the application
+        leaves the bus or is populated again, the client cache is cleared or
+        the cache type changes.
+     */
+    QList<AccessibleObject> populateClientCache(const AccessibleObject &application);
+
+    /**
+        Populates the client cache with all objects of the \a application and
+        keeps it up to date by following the AddAccessible and RemoveAccessible
+        signals of the org.a11y.atspi.Cache interface. The objects of mirrored
+        applications stay alive until stopMirroringApplication() is called or
+        the cache type changes.
+     */
+    void mirrorApplication(const AccessibleObject &application);
+    void stopMirroringApplication(const AccessibleObject &application);
+
+    /**
+        Returns the counters collected since the cache type was set or the
+        counters were reset last, together with the number of cached objects
+        and an estimate of the memory they occupy. The counters are reset
+        after taking the snapshot if \a reset is true.
+     */
+    CacheStatistics cacheStatistics(bool reset = false);
+
+    /**
+        Returns the legacy reply signatures seen by service, for example
+        "GetIndexInParent(u)" for toolkits still replying with an unsigned index.
+     */
+    QHash<QString, QStringList> signatureVariants() const;
+
+    /**
+        Returns the services the registry keeps call state for, that is
+        direct connections, timeouts, responsiveness and reply signatures.
+        It is dropped when a service leaves the bus.
+     */
+    QStringList trackedServices() const;
+
 private:
     Registry *const m_registry;
 };
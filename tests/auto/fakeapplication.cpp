@@ -0,0 +1,138 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include "fakeapplication.h"
+
+#include <QDBusConnectionInterface>
+#include <QDBusReply>
+#include <QDBusVirtualObject>
+#include <QUrl>
+
+#include "qaccessibilityclient/registry.h"
+
+using namespace QAccessibleClient;
+
+class FakeObject : public QDBusVirtualObject
+{
+public:
+    explicit FakeObject(FakeApplication *application)
+        : m_application(application)
+    {}
+
+    QString introspect(const QString &path) const override
+    {
+        Q_UNUSED(path)
+        return QString();
+    }
+    bool handleMessage(const QDBusMessage &message, const QDBusConnection &connection) override
+    {
+        m_application->handleMessage(message, connection);
+        return true;
+    }
+
+private:
+    FakeApplication *const m_application;
+};
+
+FakeApplication::FakeApplication()
+    : m_object(new FakeObject(this))
+    , m_connectionName(QStringLiteral("fakeapplication-%1").arg(quintptr(this)))
+{
+    m_thread.start();
+    m_object->moveToThread(&m_thread);
+}
+
+FakeApplication::~FakeApplication()
+{
+    QDBusConnection connection(m_connectionName);
+    if (connection.isConnected())
+        connection.unregisterObject(QStringLiteral("/"), QDBusConnection::UnregisterTree);
+    QDBusConnection::disconnectFromBus(m_connectionName);
+    m_thread.quit();
+    m_thread.wait();
+    delete m_object;
+}
+
+bool FakeApplication::start()
+{
+    // The registry talks to the accessibility bus if there is one.
+    const QDBusMessage message = QDBusMessage::createMethodCall(QStringLiteral("org.a11y.Bus"), QStringLiteral("/org/a11y/bus"),
+                                                                QStringLiteral("org.a11y.Bus"), QStringLiteral("GetAddress"));
+    const QDBusReply<QString> address = QDBusConnection::sessionBus().call(message);
+    const QDBusConnection connection = address.isValid() && !address.value().isEmpty()
+            ? QDBusConnection::connectToBus(address.value(), m_connectionName)
+            : QDBusConnection::connectToBus(QDBusConnection::SessionBus, m_connectionName);
+    if (!connection.isConnected())
+        return false;
+    return QDBusConnection(m_connectionName).registerVirtualObject(QStringLiteral("/"), m_object, QDBusConnection::SubPath);
+}
+
+bool FakeApplication::registerService(const QString &name)
+{
+    const QDBusReply<QDBusConnectionInterface::RegisterServiceReply> reply =
+            QDBusConnection(m_connectionName).interface()->registerService(name);
+    if (!reply.isValid() || reply.value() != QDBusConnectionInterface::ServiceRegistered)
+        return false;
+    m_serviceName = name;
+    return true;
+}
+
+QString FakeApplication::service() const
+{
+    if (!m_serviceName.isEmpty())
+        return m_serviceName;
+    return QDBusConnection(m_connectionName).baseService();
+}
+
+AccessibleObject FakeApplication::object(const Registry &registry, const QString &path) const
+{
+    QUrl url;
+    url.setScheme(QStringLiteral("accessibleobject"));
+    url.setPath(path);
+    url.setFragment(service());
+    return registry.accessibleFromUrl(url);
+}
+
+QString FakeApplication::rootPath()
+{
+    return QStringLiteral("/org/a11y/atspi/accessible/root");
+}
+
+void FakeApplication::setHandler(const QString &interface, const QString &member, const Handler &handler)
+{
+    QMutexLocker locker(&m_mutex);
+    m_handlers.insert(interface + QLatin1Char('.') + member, handler);
+}
+
+int FakeApplication::calls(const QString &member) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_calls.value(member);
+}
+
+void FakeApplication::sendSignal(const QString &path, const QString &interface, const QString &member, const QVariantList &arguments)
+{
+    QDBusMessage signal = QDBusMessage::createSignal(path, interface, member);
+    signal.setArguments(arguments);
+    QDBusConnection(m_connectionName).send(signal);
+}
+
+void FakeApplication::handleMessage(const QDBusMessage &message, const QDBusConnection &connection)
+{
+    Handler handler;
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_calls[message.member()];
+        handler = m_handlers.value(message.interface() + QLatin1Char('.') + message.member());
+    }
+    if (!handler) {
+        connection.send(message.createErrorReply(QDBusError::UnknownMethod, message.member()));
+        return;
+    }
+    const QDBusMessage reply = handler(message);
+    if (reply.type() != QDBusMessage::InvalidMessage)
+        connection.send(reply);
+}
@@ -0,0 +1,68 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef FAKEAPPLICATION_H
+#define FAKEAPPLICATION_H
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+#include <functional>
+
+#include "qaccessibilityclient/accessibleobject.h"
+
+namespace QAccessibleClient {
+class Registry;
+}
+
+class FakeObject;
+
+/**
+    Stands in for an application on the bus the registry uses.
+
+    Calls are answered by handlers the test sets, in a thread of their own.
+    A handler that blocks freezes the fake like a busy application while its
+    bus connection keeps working, for example answering Peer.Ping.
+ */
+class FakeApplication
+{
+public:
+    /// Returns the reply to \a call, an invalid message sends no reply at all.
+    typedef std::function<QDBusMessage(const QDBusMessage &call)> Handler;
+
+    FakeApplication();
+    ~FakeApplication();
+
+    /// Connects to the bus, returns false if that fails.
+    bool start();
+    /// Additionally owns the well-known \a name, which service() returns from then on.
+    bool registerService(const QString &name);
+    QString service() const;
+    QAccessibleClient::AccessibleObject object(const QAccessibleClient::Registry &registry, const QString &path = rootPath()) const;
+    static QString rootPath();
+
+    void setHandler(const QString &interface, const QString &member, const Handler &handler);
+    /// Number of calls of \a member that arrived so far.
+    int calls(const QString &member) const;
+    void sendSignal(const QString &path, const QString &interface, const QString &member, const QVariantList &arguments);
+
+private:
+    friend class FakeObject;
+    void handleMessage(const QDBusMessage &message, const QDBusConnection &connection);
+
+    QThread m_thread;
+    FakeObject *m_object;
+    QString m_connectionName;
+    QString m_serviceName;
+    mutable QMutex m_mutex;
+    QHash<QString, Handler> m_handlers;
+    QHash<QString, int> m_calls;
+};
+
+#endif
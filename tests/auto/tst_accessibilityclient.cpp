@@ -15,17 +15,191 @@
 #include <QAccessible>
 #include <QDebug>
 #include <QProcess>
+#include <QSignalSpy>
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QScopeGuard>
+#include <QSemaphore>
+#include <QThread>
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QDBusReply>
+
+#include <signal.h>
 
 #include "qaccessibilityclient/registry.h"
 #include "qaccessibilityclient/accessibleobject.h"
+#include "qaccessibilityclient/registrycache_p.h"
 
+#include "atspi/atspi-constants.h"
 #include "atspi/dbusconnection.h"
 
+#include "fakeapplication.h"
+
 typedef QSharedPointer<QAccessibleInterface> QAIPointer;
 
 using namespace QAccessibleClient;
 
+// Marshalled like the object references and org.a11y.atspi.Cache items toolkits send.
+struct FakeReference
+{
+    QString service;
+    QDBusObjectPath path;
+};
+Q_DECLARE_METATYPE(FakeReference)
+
+struct FakeCacheItem
+{
+    FakeReference object;
+    FakeReference parent;
+    int indexInParent = -1;
+    int childCount = 0;
+    QList<FakeReference> children;
+    QString name;
+};
+Q_DECLARE_METATYPE(FakeCacheItem)
+
+// The same item in the legacy layout that lists the children.
+struct FakeLegacyCacheItem : FakeCacheItem
+{
+};
+Q_DECLARE_METATYPE(FakeLegacyCacheItem)
+
+struct FakeAction
+{
+    QString name;
+    QString description;
+    QString keyBinding;
+};
+Q_DECLARE_METATYPE(FakeAction)
+
+QDBusArgument &operator<<(QDBusArgument &argument, const FakeReference &reference)
+{
+    argument.beginStructure();
+    argument << reference.service << reference.path;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, FakeReference &reference)
+{
+    argument.beginStructure();
+    argument >> reference.service >> reference.path;
+    argument.endStructure();
+    return argument;
+}
+
+static void writeCacheItem(QDBusArgument &argument, const FakeCacheItem &item, bool legacy)
+{
+    const FakeReference application = { item.object.service, QDBusObjectPath(FakeApplication::rootPath()) };
+    argument.beginStructure();
+    argument << item.object << application << item.parent;
+    if (legacy)
+        argument << item.children;
+    else
+        argument << item.indexInParent << item.childCount;
+    argument << QStringList(QStringLiteral("org.a11y.atspi.Accessible")) << item.name << uint(ATSPI_ROLE_PUSH_BUTTON) << QString()
+             << (QList<uint>() << 0 << 0);
+    argument.endStructure();
+}
+
+static void readCacheItem(const QDBusArgument &argument, FakeCacheItem &item, bool legacy)
+{
+    FakeReference application;
+    QStringList interfaces;
+    uint role;
+    QString description;
+    QList<uint> state;
+    argument.beginStructure();
+    argument >> item.object >> application >> item.parent;
+    if (legacy)
+        argument >> item.children;
+    else
+        argument >> item.indexInParent >> item.childCount;
+    argument >> interfaces >> item.name >> role >> description >> state;
+    argument.endStructure();
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const FakeCacheItem &item)
+{
+    writeCacheItem(argument, item, false);
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, FakeCacheItem &item)
+{
+    readCacheItem(argument, item, false);
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const FakeLegacyCacheItem &item)
+{
+    writeCacheItem(argument, item, true);
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, FakeLegacyCacheItem &item)
+{
+    readCacheItem(argument, item, true);
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const FakeAction &action)
+{
+    argument.beginStructure();
+    argument << action.name << action.description << action.keyBinding;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, FakeAction &action)
+{
+    argument.beginStructure();
+    argument >> action.name >> action.description >> action.keyBinding;
+    argument.endStructure();
+    return argument;
+}
+
+static FakeCacheItem fakeCacheItem(const QString &service, const QString &path, const QString &parentPath, int indexInParent, const QString &name)
+{
+    FakeCacheItem item;
+    item.object = { service, QDBusObjectPath(path) };
+    item.parent = { parentPath.isEmpty() ? QString() : service, QDBusObjectPath(parentPath.isEmpty() ? QStringLiteral("/org/a11y/atspi/null") : parentPath) };
+    item.indexInParent = indexInParent;
+    item.name = name;
+    return item;
+}
+
+// Sends an AT-SPI event about the object at \a path.
+static void sendObjectEvent(FakeApplication &app, const QString &path, const QString &interface, const QString &member, const QString &kind)
+{
+    const FakeReference root = { app.service(), QDBusObjectPath(FakeApplication::rootPath()) };
+    app.sendSignal(path, interface, member, QVariantList() << kind << 0 << 0
+                   << QVariant::fromValue(QDBusVariant(QString())) << QVariant::fromValue(root));
+}
+
+// The root with the children A and B, A with the child C.
+static QList<FakeCacheItem> fakeCacheItems(const QString &service)
+{
+    const QString root = FakeApplication::rootPath();
+    const QString a = QStringLiteral("/org/a11y/atspi/accessible/a");
+    QList<FakeCacheItem> items;
+    items << fakeCacheItem(service, root, QString(), -1, QStringLiteral("Root"))
+          << fakeCacheItem(service, a, root, 0, QStringLiteral("A"))
+          << fakeCacheItem(service, QStringLiteral("/org/a11y/atspi/accessible/b"), root, 1, QStringLiteral("B"))
+          << fakeCacheItem(service, QStringLiteral("/org/a11y/atspi/accessible/c"), a, 0, QStringLiteral("C"));
+    // Child counts and lists follow from the parents.
+    for (FakeCacheItem &item : items) {
+        for (const FakeCacheItem &child : std::as_const(items)) {
+            if (child.parent.path == item.object.path)
+                item.children.append(child.object);
+        }
+        item.childCount = item.children.size();
+    }
+    return items;
+}
+
 struct Event {
     Event(const AccessibleObject &obj)
         : object(obj)
@@ -46,6 +220,27 @@ public:
     QList<Event> focusEvents;
 };
 
+class ThreadRecorder : public QObject
+{
+    Q_OBJECT
+public Q_SLOTS:
+    void focus(const QAccessibleClient::AccessibleObject &object) {
+        Q_UNUSED(object)
+        QMutexLocker locker(&mutex);
+        threads.append(QThread::currentThread());
+    }
+
+public:
+    QList<QThread*> receivedIn() {
+        QMutexLocker locker(&mutex);
+        return threads;
+    }
+
+private:
+    QMutex mutex;
+    QList<QThread*> threads;
+};
+
 class AccessibilityClientTest :public QObject
 {
     Q_OBJECT
@@ -65,6 +260,37 @@ private Q_SLOTS:
     void tst_extents();
 
     void tst_characterExtents();
+    void tst_textSelections();
+    void tst_replySignatures();
+
+    void tst_weakCacheReuse();
+    void tst_strongCache();
+    void tst_propertyCache();
+    void tst_serviceRemoved();
+    void tst_cacheStatistics();
+    void tst_eventsOfUncachedObjects();
+    void tst_defunctObjects();
+    void tst_cacheCoherence();
+    void tst_childrenCache();
+    void tst_childrenOverPooledConnection();
+    void tst_objectPaths();
+    void tst_populateCache_data();
+    void tst_populateCache();
+    void tst_mirrorApplication();
+    void tst_extentsCache();
+    void tst_extentsInvalidation();
+    void tst_staleReplies();
+    void tst_asyncGetters();
+    void tst_info();
+    void tst_sharedCalls();
+    void tst_unresponsiveApplication();
+    void tst_serviceCallState();
+    void tst_callDeadline();
+    void tst_directConnections();
+    void tst_connectionPool();
+    void tst_threads();
+    void tst_actions();
+    void tst_cachedStatus();
 
 private:
     bool startHelperProcess();
@@ -74,6 +300,14 @@ private:
 
 void AccessibilityClientTest::initTestCase()
 {
+    qDBusRegisterMetaType<FakeReference>();
+    qDBusRegisterMetaType<QList<FakeReference> >();
+    qDBusRegisterMetaType<FakeCacheItem>();
+    qDBusRegisterMetaType<QList<FakeCacheItem> >();
+    qDBusRegisterMetaType<FakeLegacyCacheItem>();
+    qDBusRegisterMetaType<QList<FakeLegacyCacheItem> >();
+    qDBusRegisterMetaType<FakeAction>();
+    qDBusRegisterMetaType<QList<FakeAction> >();
 }
 
 
@@ -92,6 +326,19 @@ AccessibleObject getAppObject(const Registry &r, const QString &appName)
     return accApp;
 }
 
+// Waits up to two seconds for the application started by startHelperProcess().
+AccessibleObject waitForHelperApp(const Registry &r)
+{
+    const QString appName = QLatin1String("LibKdeAccessibilityClient Simple Widget App");
+    for (int attempts = 0; attempts < 20; ++attempts) {
+        QTest::qWait(100);
+        const AccessibleObject remoteApp = getAppObject(r, appName);
+        if (remoteApp.isValid())
+            return remoteApp;
+    }
+    return AccessibleObject();
+}
+
 void AccessibilityClientTest::cleanup()
 {
     registry.subscribeEventListeners(Registry::NoEventListeners);
@@ -471,6 +718,1434 @@ void AccessibilityClientTest::tst_characterExtents()
     QCOMPARE(textArea.characterRect(1), textEditInterface->textInterface()->characterRect(1));
 }
 
+void AccessibilityClientTest::tst_textSelections()
+{
+    typedef QList< QPair<int,int> > Selections;
+    // Kept by the fake, which answers from a thread of its own.
+    QMutex mutex;
+    Selections selections;
+    QList<int> removed;
+
+    FakeApplication app;
+    QVERIFY(app.start());
+    const QString text = QStringLiteral("org.a11y.atspi.Text");
+    app.setHandler(text, QLatin1String("GetNSelections"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        return call.createReply(int(selections.size()));
+    });
+    app.setHandler(text, QLatin1String("GetSelection"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        const QPair<int,int> selection = selections.value(call.arguments().at(0).toInt());
+        return call.createReply(QVariantList() << selection.first << selection.second);
+    });
+    app.setHandler(text, QLatin1String("SetSelection"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        const int index = call.arguments().at(0).toInt();
+        if (index < 0 || index >= selections.size())
+            return call.createReply(false);
+        selections[index] = qMakePair(call.arguments().at(1).toInt(), call.arguments().at(2).toInt());
+        return call.createReply(true);
+    });
+    app.setHandler(text, QLatin1String("AddSelection"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        selections.append(qMakePair(call.arguments().at(0).toInt(), call.arguments().at(1).toInt()));
+        return call.createReply(true);
+    });
+    app.setHandler(text, QLatin1String("RemoveSelection"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        const int index = call.arguments().at(0).toInt();
+        if (index < 0 || index >= selections.size())
+            return call.createReply(false);
+        selections.removeAt(index);
+        removed.append(index);
+        return call.createReply(true);
+    });
+
+    Registry r;
+    const AccessibleObject object = app.object(r);
+    {
+        QMutexLocker locker(&mutex);
+        selections << qMakePair(0, 2) << qMakePair(4, 6) << qMakePair(10, 8) << qMakePair(12, 14);
+    }
+    // Each selection comes back in order, with its offsets in order.
+    QCOMPARE(object.textSelections(), Selections() << qMakePair(0, 2) << qMakePair(4, 6) << qMakePair(8, 10) << qMakePair(12, 14));
+    QCOMPARE(app.calls(QStringLiteral("GetSelection")), 4);
+
+    // Surplus selections are removed from the highest index on.
+    object.setTextSelections(Selections() << qMakePair(1, 3));
+    {
+        QMutexLocker locker(&mutex);
+        QCOMPARE(selections, Selections() << qMakePair(1, 3));
+        QCOMPARE(removed, QList<int>() << 3 << 2 << 1);
+    }
+    QCOMPARE(object.textSelections(), Selections() << qMakePair(1, 3));
+
+    // Missing ones are added behind the existing ones.
+    const Selections added = Selections() << qMakePair(0, 1) << qMakePair(5, 7) << qMakePair(9, 11);
+    object.setTextSelections(added);
+    QCOMPARE(object.textSelections(), added);
+    QCOMPARE(app.calls(QStringLiteral("AddSelection")), 2);
+
+    object.setTextSelections(Selections());
+    QCOMPARE(object.textSelections(), Selections());
+    {
+        QMutexLocker locker(&mutex);
+        QCOMPARE(removed, QList<int>() << 3 << 2 << 1 << 2 << 1 << 0);
+    }
+}
+
+void AccessibilityClientTest::tst_replySignatures()
+{
+    // Replies are either of the current signature or of a legacy one.
+    QAtomicInt legacy(0);
+    FakeApplication app;
+    QVERIFY(app.start());
+    app.setHandler(QLatin1String("org.a11y.atspi.Text"), QLatin1String("GetCharacterExtents"), [&legacy](const QDBusMessage &call) {
+        if (legacy.loadAcquire())
+            return call.createReply(QVariantList() << 1 << 2 << 3 << 4);
+        return call.createReply(QRect(1, 2, 3, 4));
+    });
+    app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetIndexInParent"), [&legacy](const QDBusMessage &call) {
+        if (legacy.loadAcquire())
+            return call.createReply(uint(7));
+        return call.createReply(7);
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    const AccessibleObject object = app.object(r);
+    QCOMPARE(object.characterRect(0), QRect(1, 2, 3, 4));
+    QCOMPARE(object.indexInParent(), 7);
+    QVERIFY(!cache.signatureVariants().contains(app.service()));
+
+    // Four integers instead of a struct, an unsigned index.
+    legacy.storeRelease(1);
+    QCOMPARE(object.characterRect(0), QRect(1, 2, 3, 4));
+    QCOMPARE(object.indexInParent(), 7);
+    QCOMPARE(cache.signatureVariants().value(app.service()),
+             QStringList() << QStringLiteral("GetCharacterExtents(iiii)") << QStringLiteral("GetIndexInParent(u)"));
+
+    // Each one is recorded once.
+    QCOMPARE(object.characterRect(0), QRect(1, 2, 3, 4));
+    QCOMPARE(cache.signatureVariants().value(app.service()).size(), 2);
+}
+
+void AccessibilityClientTest::tst_weakCacheReuse()
+{
+    FakeApplication app;
+    QVERIFY(app.start());
+    // Every object gets a name of its own, a stale entry would answer with an old one.
+    QAtomicInt names;
+    app.setHandler(QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"), [&names](const QDBusMessage &call) {
+        return call.createReply(QVariant::fromValue(QDBusVariant(QString::number(names.fetchAndAddRelaxed(1)))));
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+
+    const QString path = QStringLiteral("/org/a11y/atspi/accessible/reused");
+    const QString id = path + app.service();
+    QString previousName;
+    for (int round = 0; round < 20; ++round) {
+        AccessibleObject object = app.object(r, path);
+        const QString name = object.name();
+        QVERIFY(name != previousName);
+        QCOMPARE(cache.clientCacheObject(id), object);
+        previousName = name;
+
+        // Dropped with the last reference, then the memory is likely handed
+        // out again, to an object of another path.
+        object = AccessibleObject();
+        QVERIFY(!cache.clientCacheObjects().contains(id));
+        const QString otherPath = QStringLiteral("/org/a11y/atspi/accessible/other%1").arg(round);
+        const AccessibleObject other = app.object(r, otherPath);
+        QVERIFY(other.isValid());
+        QVERIFY(!cache.clientCacheObject(id).isValid());
+        QCOMPARE(cache.clientCacheObject(otherPath + app.service()), other);
+    }
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_strongCache()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::StrongCache);
+    QCOMPARE(cache.cacheType(), RegistryPrivateCacheApi::StrongCache);
+    cache.setCacheLimits(2, 1024 * 1024);
+    QCOMPARE(cache.cacheMaxObjects(), 2);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    QVBoxLayout *layout = new QVBoxLayout;
+    w.setLayout(layout);
+    QPushButton *button = new QPushButton;
+    button->setText(QLatin1String("Cached"));
+    layout->addWidget(button);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    QString buttonId;
+    {
+        AccessibleObject accApp = getAppObject(r, appName);
+        QVERIFY(accApp.isValid());
+        AccessibleObject accButton = accApp.child(0).child(0);
+        QVERIFY(accButton.isValid());
+        QCOMPARE(accButton.name(), button->text());
+        buttonId = accButton.id();
+    }
+
+    // no handle is left, the most recently used objects are kept alive anyway
+    QVERIFY(cache.clientCacheObjects().count() <= 2);
+    QVERIFY(cache.clientCacheObjects().contains(buttonId));
+    QCOMPARE(cache.clientCacheObject(buttonId).name(), button->text());
+
+    cache.setCacheLimits(0, 0);
+    QVERIFY(cache.clientCacheObjects().isEmpty());
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_propertyCache()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    r.subscribeEventListeners(Registry::PropertyChanged);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    w.setAccessibleName(QStringLiteral("Before"));
+    w.setAccessibleDescription(QStringLiteral("Old description"));
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject accW = getAppObject(r, appName).child(0);
+    QVERIFY(accW.isValid());
+    QCOMPARE(accW.name(), QStringLiteral("Before"));
+    QCOMPARE(accW.description(), QStringLiteral("Old description"));
+    QCOMPARE(accW.role(), AccessibleObject::Filler);
+
+    // the cached values get invalidated by the property change events
+    w.setAccessibleName(QStringLiteral("After"));
+    QTRY_COMPARE(accW.name(), QStringLiteral("After"));
+    w.setAccessibleDescription(QStringLiteral("New description"));
+    QTRY_COMPARE(accW.description(), QStringLiteral("New description"));
+    QCOMPARE(accW.role(), AccessibleObject::Filler);
+
+    r.subscribeEventListeners(Registry::NoEventListeners);
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_serviceRemoved()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    QSignalSpy removedSpy(&r, SIGNAL(removed(QAccessibleClient::AccessibleObject)));
+
+    QVERIFY(startHelperProcess());
+
+    const AccessibleObject remoteApp = waitForHelperApp(r);
+    QVERIFY(remoteApp.isValid());
+
+    AccessibleObject window = remoteApp.child(0);
+    QVERIFY(window.isValid());
+    QVERIFY(cache.clientCacheObjects().contains(window.id()));
+    const QString windowId = window.id();
+
+    // leaving the bus drops all objects of the application at once
+    helperProcess.terminate();
+    QVERIFY(helperProcess.waitForFinished());
+    QTRY_VERIFY(window.isDefunct());
+    QVERIFY(remoteApp.isDefunct());
+    QVERIFY(removedSpy.count() >= 2);
+    QVERIFY(!cache.clientCacheObjects().contains(windowId));
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_cacheStatistics()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    w.setAccessibleName(QStringLiteral("Counted"));
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject accW = getAppObject(r, appName).child(0);
+    QVERIFY(accW.isValid());
+    cache.cacheStatistics(true);
+
+    QCOMPARE(accW.name(), QStringLiteral("Counted"));
+    QCOMPARE(accW.name(), QStringLiteral("Counted"));
+    CacheStatistics statistics = cache.cacheStatistics(true);
+    QCOMPARE(statistics.fields.value(QStringLiteral("name")).misses, quint64(1));
+    QCOMPARE(statistics.fields.value(QStringLiteral("name")).inserts, quint64(1));
+    QCOMPARE(statistics.fields.value(QStringLiteral("name")).hits, quint64(1));
+    QVERIFY(statistics.fields.contains(QStringLiteral("state")));
+    QVERIFY(statistics.objects > 0);
+    QVERIFY(statistics.approximateBytes > 0);
+
+    statistics = cache.cacheStatistics();
+    QCOMPARE(statistics.fields.value(QStringLiteral("name")).hits, quint64(0));
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_eventsOfUncachedObjects()
+{
+    FakeApplication app;
+    QVERIFY(app.start());
+    app.setHandler(QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"), [](const QDBusMessage &call) {
+        return call.createReply(QVariant::fromValue(QDBusVariant(QStringLiteral("Root"))));
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    const AccessibleObject root = app.object(r);
+    auto sendEvent = [&app](const QString &path, const QString &member, const QString &kind) {
+        sendObjectEvent(app, path, QStringLiteral("org.a11y.atspi.Event.Object"), member, kind);
+    };
+    auto invalidations = [&cache]() {
+        return cache.cacheStatistics().fields.value(QStringLiteral("name")).invalidations;
+    };
+
+    // Wait until the registry receives the events.
+    for (int attempt = 0; invalidations() == 0 && attempt < 50; ++attempt) {
+        QCOMPARE(root.name(), QStringLiteral("Root"));
+        sendEvent(FakeApplication::rootPath(), QStringLiteral("PropertyChange"), QStringLiteral("accessible-name"));
+        QTest::qWait(100);
+    }
+    QVERIFY(invalidations() > 0);
+
+    // Events about objects that are not cached neither create nor intern them.
+    QCOMPARE(root.name(), QStringLiteral("Root"));
+    cache.cacheStatistics(true);
+    const int objectPaths = cache.cacheStatistics().objectPaths;
+    for (int i = 0; i < 10; ++i) {
+        const QString path = QStringLiteral("/org/a11y/atspi/accessible/uncached%1").arg(i);
+        sendEvent(path, QStringLiteral("PropertyChange"), QStringLiteral("accessible-name"));
+        sendEvent(path, QStringLiteral("StateChanged"), QStringLiteral("checked"));
+        sendEvent(path, QStringLiteral("ChildrenChanged"), QStringLiteral("add"));
+    }
+    // Events arrive in order, the one about the root comes last.
+    sendEvent(FakeApplication::rootPath(), QStringLiteral("PropertyChange"), QStringLiteral("accessible-name"));
+    QTRY_COMPARE(invalidations(), quint64(1));
+
+    const CacheStatistics statistics = cache.cacheStatistics();
+    QCOMPARE(statistics.objectPaths, objectPaths);
+    QCOMPARE(statistics.fields.value(QStringLiteral("object")).misses, quint64(0));
+    QCOMPARE(cache.clientCacheObjects(), QStringList() << root.id());
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_defunctObjects()
+{
+    FakeApplication app;
+    QVERIFY(app.start());
+    app.setHandler(QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"), [](const QDBusMessage &call) {
+        return call.createReply(QVariant::fromValue(QDBusVariant(QStringLiteral("Root"))));
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    QSignalSpy removedSpy(&r, SIGNAL(removed(QAccessibleClient::AccessibleObject)));
+    const AccessibleObject root = app.object(r);
+    const QString rootId = root.id();
+    auto sendEvent = [&app](const QString &path, const QString &kind, int detail1) {
+        const FakeReference reference = { app.service(), QDBusObjectPath(FakeApplication::rootPath()) };
+        app.sendSignal(path, QStringLiteral("org.a11y.atspi.Event.Object"), QStringLiteral("StateChanged"),
+                       QVariantList() << kind << detail1 << 0
+                       << QVariant::fromValue(QDBusVariant(QString())) << QVariant::fromValue(reference));
+    };
+    auto invalidations = [&cache]() {
+        return cache.cacheStatistics().fields.value(QStringLiteral("state")).invalidations;
+    };
+
+    // Wait until the registry receives the events, the cache listens to them on its own.
+    app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetState"), [](const QDBusMessage &call) {
+        return call.createReply(QVariant::fromValue(QVector<quint32>() << 0 << 0));
+    });
+    for (int attempt = 0; invalidations() == 0 && attempt < 50; ++attempt) {
+        root.state();
+        sendEvent(FakeApplication::rootPath(), QStringLiteral("checked"), 1);
+        QTest::qWait(100);
+    }
+    QVERIFY(invalidations() > 0);
+
+    // Uncached objects are neither created nor interned.
+    const int objectPaths = cache.cacheStatistics().objectPaths;
+    for (int i = 0; i < 10; ++i)
+        sendEvent(QStringLiteral("/org/a11y/atspi/accessible/uncached%1").arg(i), QStringLiteral("defunct"), 1);
+
+    // A cached one is dropped, without telling the user who did not ask for state changes.
+    sendEvent(FakeApplication::rootPath(), QStringLiteral("defunct"), 1);
+    QTRY_VERIFY(!cache.clientCacheObjects().contains(rootId));
+    QCOMPARE(cache.cacheStatistics().objectPaths, objectPaths);
+    QVERIFY(root.isDefunct());
+    QCOMPARE(removedSpy.count(), 0);
+
+    // Asked for, every defunct object is reported.
+    r.subscribeEventListeners(Registry::StateChanged);
+    sendEvent(QStringLiteral("/org/a11y/atspi/accessible/uncached0"), QStringLiteral("defunct"), 1);
+    QTRY_COMPARE(removedSpy.count(), 1);
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_cacheCoherence()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    // the cache subscribes to what it needs without changing the user's listeners
+    QCOMPARE(r.subscribedEventListeners(), Registry::EventListeners(Registry::NoEventListeners));
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    QVBoxLayout *layout = new QVBoxLayout;
+    w.setLayout(layout);
+    QPushButton *button = new QPushButton;
+    button->setText(QLatin1String("Coherent"));
+    layout->addWidget(button);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject accButton = getAppObject(r, appName).child(0).child(0);
+    QVERIFY(accButton.isValid());
+    QVERIFY(accButton.isEnabled());
+    button->setEnabled(false);
+    QTRY_VERIFY(!accButton.isEnabled());
+    button->setText(QLatin1String("Changed"));
+    QTRY_COMPARE(accButton.name(), QStringLiteral("Changed"));
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+    QCOMPARE(r.subscribedEventListeners(), Registry::EventListeners(Registry::NoEventListeners));
+}
+
+void AccessibilityClientTest::tst_childrenCache()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    QVBoxLayout *layout = new QVBoxLayout;
+    w.setLayout(layout);
+    QPushButton *button1 = new QPushButton;
+    button1->setText(QLatin1String("First"));
+    layout->addWidget(button1);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject accW = getAppObject(r, appName).child(0);
+    QVERIFY(accW.isValid());
+    QList<AccessibleObject> children = accW.children();
+    QCOMPARE(children.size(), 1);
+
+    // served from the cache as long as nothing changes
+    cache.cacheStatistics(true);
+    QCOMPARE(accW.children(), children);
+    QCOMPARE(accW.child(0), children.at(0));
+    QCOMPARE(accW.childCount(), 1);
+    QCOMPARE(cache.cacheStatistics().fields.value(QStringLiteral("children")).misses, quint64(0));
+
+    QPushButton *button2 = new QPushButton;
+    button2->setText(QLatin1String("Second"));
+    layout->addWidget(button2);
+    QTRY_COMPARE(accW.childCount(), 2);
+    children = accW.children();
+    QCOMPARE(children.size(), 2);
+    QCOMPARE(children.at(1).name(), button2->text());
+
+    delete button1;
+    QTRY_COMPARE(accW.childCount(), 1);
+    QCOMPARE(accW.children().at(0).name(), button2->text());
+
+    // parent and index are known from the child list and follow its changes
+    const AccessibleObject accButton2 = children.at(1);
+    cache.cacheStatistics(true);
+    QCOMPARE(accButton2.parent(), accW);
+    QCOMPARE(accButton2.indexInParent(), 0);
+    const CacheStatistics statistics = cache.cacheStatistics();
+    QCOMPARE(statistics.fields.value(QStringLiteral("parent")).misses, quint64(0));
+    QCOMPARE(statistics.fields.value(QStringLiteral("indexInParent")).misses, quint64(0));
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_childrenOverPooledConnection()
+{
+    FakeApplication app;
+    QVERIFY(app.start());
+    auto reference = [&app](const QString &name) {
+        return FakeReference{ app.service(), QDBusObjectPath(QStringLiteral("/org/a11y/atspi/accessible/") + name) };
+    };
+    QMutex mutex;
+    QList<FakeReference> children = { reference(QStringLiteral("a")) };
+    app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetChildren"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        return call.createReply(QVariant::fromValue(children));
+    });
+
+    // A pool where the calls to the application do not share the connection of the events.
+    int poolSize = 2;
+    for (; poolSize < 16; ++poolSize) {
+        DBusConnection connection;
+        connection.setPoolSize(poolSize);
+        if (connection.connection(app.service()).name() != connection.connection().name())
+            break;
+    }
+    QVERIFY(poolSize < 16);
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    r.setConnectionPoolSize(poolSize);
+    r.subscribeEventListeners(Registry::ChildrenChanged);
+    QSignalSpy addedSpy(&r, SIGNAL(childAdded(QAccessibleClient::AccessibleObject,int)));
+    const AccessibleObject root = app.object(r);
+    auto sendChildAdded = [&app](int index, const FakeReference &child) {
+        const FakeReference rootReference = { app.service(), QDBusObjectPath(FakeApplication::rootPath()) };
+        app.sendSignal(FakeApplication::rootPath(), QStringLiteral("org.a11y.atspi.Event.Object"), QStringLiteral("ChildrenChanged"),
+                       QVariantList() << QStringLiteral("add") << index << 0
+                       << QVariant::fromValue(QDBusVariant(QVariant::fromValue(child))) << QVariant::fromValue(rootReference));
+    };
+
+    // Wait until the registry receives the events.
+    for (int attempt = 0; addedSpy.isEmpty() && attempt < 50; ++attempt) {
+        sendChildAdded(0, reference(QStringLiteral("a")));
+        QTest::qWait(100);
+    }
+    QVERIFY(!addedSpy.isEmpty());
+
+    // The application added b and c in front of a, the reply overtakes the events.
+    {
+        QMutexLocker locker(&mutex);
+        children = { reference(QStringLiteral("c")), reference(QStringLiteral("b")), reference(QStringLiteral("a")) };
+    }
+    const QList<AccessibleObject> fetched = root.children();
+    QCOMPARE(fetched.size(), 3);
+    const int calls = app.calls(QStringLiteral("GetChildren"));
+    addedSpy.clear();
+    sendChildAdded(0, reference(QStringLiteral("b")));
+    sendChildAdded(0, reference(QStringLiteral("c")));
+    QTRY_COMPARE(addedSpy.count(), 2);
+
+    // Fetched again instead of adding them twice.
+    QCOMPARE(root.children(), fetched);
+    QCOMPARE(app.calls(QStringLiteral("GetChildren")), calls + 1);
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_objectPaths()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    QVBoxLayout *layout = new QVBoxLayout;
+    w.setLayout(layout);
+    for (int i = 0; i < 20; ++i)
+        layout->addWidget(new QPushButton(QString::number(i)));
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject accW = getAppObject(r, appName).child(0);
+    QVERIFY(accW.isValid());
+    const int before = cache.cacheStatistics().objectPaths;
+
+    QList<AccessibleObject> children = accW.children();
+    QCOMPARE(children.size(), 20);
+    QVERIFY(cache.cacheStatistics().objectPaths >= before + 20);
+
+    // The cached child list of the window still refers to the buttons.
+    children.clear();
+    QVERIFY(cache.cacheStatistics().objectPaths >= before + 20);
+
+    // Once nothing refers to them the paths are forgotten.
+    accW = AccessibleObject();
+    QVERIFY(cache.cacheStatistics().objectPaths < before);
+
+    // Walking the same objects again reuses the released ids.
+    accW = getAppObject(r, appName).child(0);
+    QCOMPARE(accW.children().size(), 20);
+    QCOMPARE(accW.children().at(3).name(), QStringLiteral("3"));
+    accW = AccessibleObject();
+    QVERIFY(cache.cacheStatistics().objectPaths < before);
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_populateCache_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::newRow("current") << false;
+    QTest::newRow("legacy") << true;
+}
+
+void AccessibilityClientTest::tst_populateCache()
+{
+    QFETCH(bool, legacy);
+
+    FakeApplication app;
+    QVERIFY(app.start());
+    const QList<FakeCacheItem> items = fakeCacheItems(app.service());
+    app.setHandler(QLatin1String("org.a11y.atspi.Cache"), QLatin1String("GetItems"), [items, legacy](const QDBusMessage &call) {
+        if (!legacy)
+            return call.createReply(QVariant::fromValue(items));
+        QList<FakeLegacyCacheItem> legacyItems;
+        for (const FakeCacheItem &item : items) {
+            FakeLegacyCacheItem legacyItem;
+            static_cast<FakeCacheItem&>(legacyItem) = item;
+            legacyItems.append(legacyItem);
+        }
+        return call.createReply(QVariant::fromValue(legacyItems));
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    const AccessibleObject root = app.object(r);
+    int populated = 0;
+    {
+        const QList<AccessibleObject> objects = cache.populateClientCache(root);
+        populated = objects.size();
+    }
+    QCOMPARE(populated, items.size());
+
+    // The whole tree is answered from the cache, the registry keeps it alive.
+    cache.cacheStatistics(true);
+    const QList<AccessibleObject> children = root.children();
+    QCOMPARE(children.size(), 2);
+    QCOMPARE(children.at(0).name(), QStringLiteral("A"));
+    QCOMPARE(children.at(1).name(), QStringLiteral("B"));
+    QCOMPARE(children.at(1).childCount(), 0);
+    QCOMPARE(children.at(1).indexInParent(), 1);
+    const QList<AccessibleObject> grandChildren = children.at(0).children();
+    QCOMPARE(grandChildren.size(), 1);
+    QCOMPARE(grandChildren.at(0).name(), QStringLiteral("C"));
+    QCOMPARE(grandChildren.at(0).parent(), children.at(0));
+
+    const CacheStatistics statistics = cache.cacheStatistics();
+    QCOMPARE(statistics.fields.value(QStringLiteral("children")).misses, quint64(0));
+    QCOMPARE(statistics.fields.value(QStringLiteral("name")).misses, quint64(0));
+    QCOMPARE(statistics.fields.value(QStringLiteral("parent")).misses, quint64(0));
+    QCOMPARE(app.calls(QStringLiteral("GetItems")), 1);
+    QCOMPARE(app.calls(QStringLiteral("GetChildren")), 0);
+    QCOMPARE(app.calls(QStringLiteral("Get")), 0);
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_mirrorApplication()
+{
+    FakeApplication app;
+    QVERIFY(app.start());
+    const QString service = app.service();
+    const QList<FakeCacheItem> items = fakeCacheItems(service);
+    app.setHandler(QLatin1String("org.a11y.atspi.Cache"), QLatin1String("GetItems"), [items](const QDBusMessage &call) {
+        return call.createReply(QVariant::fromValue(items));
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    QSignalSpy removedSpy(&r, SIGNAL(removed(QAccessibleClient::AccessibleObject)));
+    const AccessibleObject root = app.object(r);
+    cache.mirrorApplication(root);
+    QVERIFY(cache.clientCacheObjects().contains(items.at(3).object.path.path() + service));
+
+    // Objects announced later are mirrored as well.
+    const QString path = QStringLiteral("/org/a11y/atspi/accessible/d");
+    const FakeCacheItem added = fakeCacheItem(service, path, FakeApplication::rootPath(), 2, QStringLiteral("D"));
+    app.sendSignal(QStringLiteral("/org/a11y/atspi/cache"), QStringLiteral("org.a11y.atspi.Cache"), QStringLiteral("AddAccessible"),
+                   QVariantList() << QVariant::fromValue(added));
+    QTRY_VERIFY(cache.clientCacheObjects().contains(path + service));
+    const AccessibleObject accD = cache.clientCacheObject(path + service);
+    QVERIFY(accD.isValid());
+    cache.cacheStatistics(true);
+    QCOMPARE(accD.name(), QStringLiteral("D"));
+    QCOMPARE(accD.parent(), root);
+    QCOMPARE(cache.cacheStatistics().fields.value(QStringLiteral("name")).misses, quint64(0));
+
+    app.sendSignal(QStringLiteral("/org/a11y/atspi/cache"), QStringLiteral("org.a11y.atspi.Cache"), QStringLiteral("RemoveAccessible"),
+                   QVariantList() << QVariant::fromValue(added.object));
+    QTRY_COMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(0).value<AccessibleObject>(), accD);
+    QVERIFY(accD.isDefunct());
+
+    cache.stopMirroringApplication(root);
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_extentsCache()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    w.resize(200, 100);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject accW = getAppObject(r, appName).child(0);
+    QVERIFY(accW.isValid());
+    cache.cacheStatistics(true);
+    const QRect extents = accW.boundingRect();
+    QCOMPARE(extents.size(), QSize(200, 100));
+    QCOMPARE(accW.boundingRect(), extents);
+    const CacheFieldStatistics statistics = cache.cacheStatistics().fields.value(QStringLiteral("extents"));
+    QCOMPARE(statistics.misses, quint64(1));
+    QCOMPARE(statistics.hits, quint64(1));
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_extentsInvalidation()
+{
+    FakeApplication app;
+    QVERIFY(app.start());
+    const QList<FakeCacheItem> items = fakeCacheItems(app.service());
+    app.setHandler(QLatin1String("org.a11y.atspi.Cache"), QLatin1String("GetItems"), [items](const QDBusMessage &call) {
+        return call.createReply(QVariant::fromValue(items));
+    });
+    app.setHandler(QLatin1String("org.a11y.atspi.Component"), QLatin1String("GetExtents"), [](const QDBusMessage &call) {
+        return call.createReply(QRect(0, 0, 10, 10));
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    const QList<AccessibleObject> objects = cache.populateClientCache(app.object(r));
+    QCOMPARE(objects.size(), 4);
+    QCOMPARE(objects.at(3).name(), QStringLiteral("C"));
+    const AccessibleObject accB = objects.at(2);
+    const QString pathA = items.at(1).object.path.path();
+    const QString pathC = items.at(3).object.path.path();
+    auto fetchExtents = [&objects]() {
+        for (const AccessibleObject &object : objects)
+            object.boundingRect();
+    };
+    auto invalidations = [&cache]() {
+        return cache.cacheStatistics().fields.value(QStringLiteral("extents")).invalidations;
+    };
+
+    // Wait until the registry receives the events.
+    const QString boundsChanged = QStringLiteral("BoundsChanged");
+    const QString objectEvents = QStringLiteral("org.a11y.atspi.Event.Object");
+    for (int attempt = 0; invalidations() == 0 && attempt < 50; ++attempt) {
+        fetchExtents();
+        sendObjectEvent(app, pathC, objectEvents, boundsChanged, QString());
+        QTest::qWait(100);
+    }
+    QVERIFY(invalidations() > 0);
+
+    // C changed, its ancestors may have changed, B keeps its extents.
+    fetchExtents();
+    cache.cacheStatistics(true);
+    sendObjectEvent(app, pathC, objectEvents, boundsChanged, QString());
+    QTRY_COMPARE(invalidations(), quint64(3));
+    cache.cacheStatistics(true);
+    fetchExtents();
+    QCOMPARE(cache.cacheStatistics().fields.value(QStringLiteral("extents")).misses, quint64(3));
+
+    // A changed, that moves C along.
+    cache.cacheStatistics(true);
+    sendObjectEvent(app, pathA, objectEvents, boundsChanged, QString());
+    QTRY_COMPARE(invalidations(), quint64(3));
+    cache.cacheStatistics(true);
+    accB.boundingRect();
+    QCOMPARE(cache.cacheStatistics(true).fields.value(QStringLiteral("extents")).hits, quint64(1));
+    fetchExtents();
+
+    // Moving a window outdates everything.
+    sendObjectEvent(app, FakeApplication::rootPath(), QStringLiteral("org.a11y.atspi.Event.Window"), QStringLiteral("Move"), QString());
+    QTRY_VERIFY(invalidations() > 0);
+    cache.cacheStatistics(true);
+    fetchExtents();
+    QCOMPARE(cache.cacheStatistics().fields.value(QStringLiteral("extents")).misses, quint64(4));
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_staleReplies()
+{
+    // Replies carry the values of when the application answered, the test
+    // changes them while it holds back the reply.
+    FakeApplication app;
+    QVERIFY(app.start());
+    QMutex mutex;
+    QString name = QStringLiteral("Old");
+    QRect extents(0, 0, 10, 10);
+    QSemaphore answering;
+    QAtomicInt holdBack(0);
+    app.setHandler(QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        const QString value = name;
+        locker.unlock();
+        if (holdBack.loadAcquire())
+            answering.tryAcquire(1, 10000);
+        return call.createReply(QVariant::fromValue(QDBusVariant(value)));
+    });
+    app.setHandler(QLatin1String("org.a11y.atspi.Component"), QLatin1String("GetExtents"), [&](const QDBusMessage &call) {
+        QMutexLocker locker(&mutex);
+        const QRect value = extents;
+        locker.unlock();
+        if (holdBack.loadAcquire())
+            answering.tryAcquire(1, 10000);
+        return call.createReply(value);
+    });
+
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+    r.setCallTimeout(QString(), 10000);
+    r.subscribeEventListeners(Registry::PropertyChanged | Registry::Window);
+    QSignalSpy nameSpy(&r, SIGNAL(accessibleNameChanged(QAccessibleClient::AccessibleObject)));
+    QSignalSpy moveSpy(&r, SIGNAL(windowMoved(QAccessibleClient::AccessibleObject)));
+    const AccessibleObject root = app.object(r);
+    auto sendNameChange = [&app]() {
+        sendObjectEvent(app, FakeApplication::rootPath(), QStringLiteral("org.a11y.atspi.Event.Object"),
+                        QStringLiteral("PropertyChange"), QStringLiteral("accessible-name"));
+    };
+
+    // Wait until the registry receives the events.
+    for (int attempt = 0; nameSpy.isEmpty() && attempt < 50; ++attempt) {
+        sendNameChange();
+        QTest::qWait(100);
+    }
+    QVERIFY(!nameSpy.isEmpty());
+
+    // The name changes after the application answered, before the reply arrives.
+    holdBack.storeRelease(1);
+    const int nameCalls = app.calls(QStringLiteral("Get"));
+    const QFuture<QString> staleName = root.nameAsync();
+    QTRY_COMPARE(app.calls(QStringLiteral("Get")), nameCalls + 1);
+    {
+        QMutexLocker locker(&mutex);
+        name = QStringLiteral("New");
+    }
+    nameSpy.clear();
+    sendNameChange();
+    QTRY_COMPARE(nameSpy.count(), 1);
+    // Does not join the call that went out before the change.
+    const QFuture<QString> freshName = root.nameAsync();
+    answering.release(2);
+    QTRY_VERIFY(staleName.isFinished() && freshName.isFinished());
+    QCOMPARE(staleName.result(), QStringLiteral("Old"));
+    QCOMPARE(freshName.result(), QStringLiteral("New"));
+    QCOMPARE(app.calls(QStringLiteral("Get")), nameCalls + 2);
+    holdBack.storeRelease(0);
+    QCOMPARE(root.name(), QStringLiteral("New"));
+
+    // Same for the extents when a window moves.
+    holdBack.storeRelease(1);
+    const int extentsCalls = app.calls(QStringLiteral("GetExtents"));
+    const QFuture<QRect> staleExtents = root.boundingRectAsync();
+    QTRY_COMPARE(app.calls(QStringLiteral("GetExtents")), extentsCalls + 1);
+    {
+        QMutexLocker locker(&mutex);
+        extents = QRect(20, 20, 10, 10);
+    }
+    sendObjectEvent(app, FakeApplication::rootPath(), QStringLiteral("org.a11y.atspi.Event.Window"), QStringLiteral("Move"), QString());
+    QTRY_COMPARE(moveSpy.count(), 1);
+    answering.release();
+    QTRY_VERIFY(staleExtents.isFinished());
+    QCOMPARE(staleExtents.result(), QRect(0, 0, 10, 10));
+    holdBack.storeRelease(0);
+    QCOMPARE(root.boundingRect(), QRect(20, 20, 10, 10));
+    QCOMPARE(app.calls(QStringLiteral("GetExtents")), extentsCalls + 2);
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_asyncGetters()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    w.setAccessibleName(QLatin1String("Root Widget"));
+    w.resize(200, 100);
+    QPushButton *button = new QPushButton(QLatin1String("Button"), &w);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject app = getAppObject(r, appName);
+    QVERIFY(app.isValid());
+    AccessibleObject accW = app.child(0);
+    QVERIFY(accW.isValid());
+
+    QFuture<QString> name = accW.nameAsync();
+    QFuture<AccessibleObject::Role> role = accW.roleAsync();
+    QFuture<QList<AccessibleObject> > children = accW.childrenAsync();
+    QFuture<QRect> extents = accW.boundingRectAsync();
+    QFuture<AccessibleObject> parent = accW.parentAsync();
+    QTRY_VERIFY(name.isFinished() && role.isFinished() && children.isFinished()
+                && extents.isFinished() && parent.isFinished());
+
+    QCOMPARE(name.result(), w.accessibleName());
+    QCOMPARE(role.result(), AccessibleObject::Filler);
+    QCOMPARE(children.result().count(), 1);
+    QCOMPARE(children.result().first().name(), button->text());
+    QCOMPARE(extents.result().size(), QSize(200, 100));
+    QCOMPARE(parent.result(), app);
+
+    // The replies filled the cache, so asking again does not go to the application.
+    QFuture<QString> cachedName = accW.nameAsync();
+    QVERIFY(cachedName.isFinished());
+    QCOMPARE(cachedName.result(), w.accessibleName());
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_info()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::WeakCache);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    w.setAccessibleName(QLatin1String("Root Widget"));
+    w.setAccessibleDescription(QLatin1String("This is a useless widget"));
+    QPushButton *button = new QPushButton(QLatin1String("Button"), &w);
+    Q_UNUSED(button);
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject app = getAppObject(r, appName);
+    QVERIFY(app.isValid());
+    AccessibleObject accW = app.child(0);
+    QVERIFY(accW.isValid());
+
+    const AccessibleObjectInfo info = accW.info();
+    cache.cacheStatistics(true);
+    QCOMPARE(info.name, w.accessibleName());
+    QCOMPARE(info.description, w.accessibleDescription());
+    QCOMPARE(info.role, AccessibleObject::Filler);
+    QCOMPARE(info.roleName, QLatin1String("filler"));
+    QCOMPARE(info.childCount, 1);
+    QCOMPARE(info.parent, app);
+    QVERIFY(info.interfaces & AccessibleObject::ComponentInterface);
+    QCOMPARE(info.stateString, accW.stateString());
+
+    // The snapshot filled the cache, the getters are all hits now.
+    QCOMPARE(accW.name(), info.name);
+    QCOMPARE(accW.role(), info.role);
+    QCOMPARE(accW.childCount(), info.childCount);
+    const CacheStatistics statistics = cache.cacheStatistics();
+    QCOMPARE(statistics.fields.value(QStringLiteral("name")).misses, quint64(0));
+    QCOMPARE(statistics.fields.value(QStringLiteral("role")).misses, quint64(0));
+    QCOMPARE(statistics.fields.value(QStringLiteral("state")).misses, quint64(0));
+
+    // So is the next snapshot.
+    const AccessibleObjectInfo cachedInfo = accW.info();
+    QCOMPARE(cachedInfo.name, info.name);
+    QCOMPARE(cachedInfo.role, info.role);
+    QCOMPARE(cachedInfo.roleName, info.roleName);
+    QCOMPARE(cachedInfo.parent, info.parent);
+    QCOMPARE(cachedInfo.stateString, info.stateString);
+    QCOMPARE(cachedInfo.interfaces, info.interfaces);
+    const CacheStatistics cachedStatistics = cache.cacheStatistics();
+    QCOMPARE(cachedStatistics.fields.value(QStringLiteral("name")).misses, quint64(0));
+    QCOMPARE(cachedStatistics.fields.value(QStringLiteral("role")).misses, quint64(0));
+    QCOMPARE(cachedStatistics.fields.value(QStringLiteral("state")).misses, quint64(0));
+    QCOMPARE(cachedStatistics.fields.value(QStringLiteral("interfaces")).misses, quint64(0));
+
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+}
+
+void AccessibilityClientTest::tst_sharedCalls()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+    cache.setCacheType(RegistryPrivateCacheApi::NoCache);
+
+    QString appName = QLatin1String("Lib QAccessibleClient test");
+    qApp->setApplicationName(appName);
+    QWidget w;
+    w.setAccessibleName(QLatin1String("Root Widget"));
+    w.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&w));
+
+    AccessibleObject accW = getAppObject(r, appName).child(0);
+    QVERIFY(accW.isValid());
+
+    cache.cacheStatistics(true);
+    QFuture<QString> first = accW.nameAsync();
+    QFuture<QString> second = accW.nameAsync();
+    // Blocks on the very same call.
+    QCOMPARE(accW.name(), w.accessibleName());
+    QTRY_VERIFY(first.isFinished() && second.isFinished());
+    QCOMPARE(first.result(), w.accessibleName());
+    QCOMPARE(second.result(), w.accessibleName());
+    QCOMPARE(cache.cacheStatistics().coalescedCalls, quint64(2));
+
+    // Once answered the next call goes out again.
+    QCOMPARE(accW.name(), w.accessibleName());
+    QCOMPARE(cache.cacheStatistics().coalescedCalls, quint64(2));
+
+    // A shared call that times out counts once, however many wait for it.
+    FakeApplication app;
+    QVERIFY(app.start());
+    app.setHandler(QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"), [](const QDBusMessage &) {
+        return QDBusMessage();
+    });
+    r.setUnresponsiveThreshold(3);
+    r.setCallTimeout(QString(), 200);
+    QSignalSpy respondingSpy(&r, SIGNAL(applicationRespondingChanged(QAccessibleClient::AccessibleObject,bool)));
+    const AccessibleObject frozen = app.object(r);
+    first = frozen.nameAsync();
+    second = frozen.nameAsync();
+    QVERIFY(frozen.name().isEmpty());
+    QTRY_VERIFY(first.isFinished() && second.isFinished());
+    QCOMPARE(app.calls(QStringLiteral("Get")), 1);
+    QCOMPARE(cache.cacheStatistics().coalescedCalls, quint64(4));
+    QTest::qWait(100);
+    QCOMPARE(respondingSpy.count(), 0);
+
+    // Nor does a caller with a deadline wait for a call it did not send.
+    first = frozen.nameAsync();
+    {
+        CallDeadline deadline(r, 300);
+        QVERIFY(frozen.name().isEmpty());
+    }
+    QTRY_VERIFY(first.isFinished());
+    QCOMPARE(app.calls(QStringLiteral("Get")), 3);
+    QCOMPARE(cache.cacheStatistics().coalescedCalls, quint64(4));
+    // That makes three timeouts in a row.
+    QTRY_COMPARE(respondingSpy.count(), 1);
+}
+
+void AccessibilityClientTest::tst_unresponsiveApplication()
+{
+    Registry r;
+    r.setUnresponsiveThreshold(2);
+    r.setUnresponsiveProbeInterval(200);
+    // Frozen calls fail soon instead of after the D-Bus default.
+    r.setCallTimeout(QString(), 500);
+    QSignalSpy respondingSpy(&r, SIGNAL(applicationRespondingChanged(QAccessibleClient::AccessibleObject,bool)));
+
+    QVERIFY(startHelperProcess());
+
+    const AccessibleObject remoteApp = waitForHelperApp(r);
+    QVERIFY(remoteApp.isValid());
+    AccessibleObject window = remoteApp.child(0);
+    QVERIFY(window.isValid());
+    const QString name = window.name();
+
+    // A frozen application times out twice, then calls fail right away.
+    ::kill(helperProcess.processId(), SIGSTOP);
+    window.name();
+    window.name();
+    QTRY_COMPARE(respondingSpy.count(), 1);
+    QCOMPARE(respondingSpy.at(0).at(0).value<AccessibleObject>(), remoteApp);
+    QCOMPARE(respondingSpy.at(0).at(1).toBool(), false);
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(window.name().isEmpty());
+    QVERIFY(timer.elapsed() < 250);
+
+    // The background ping notices when it answers again.
+    ::kill(helperProcess.processId(), SIGCONT);
+    QTRY_COMPARE(respondingSpy.count(), 2);
+    QCOMPARE(respondingSpy.at(1).at(1).toBool(), true);
+    QCOMPARE(window.name(), name);
+
+    helperProcess.terminate();
+    QVERIFY(helperProcess.waitForFinished());
+
+    // An application that is busy still answers pings through its bus
+    // connection, only calls to it tell whether it responds again.
+    FakeApplication app;
+    QVERIFY(app.start());
+    QSemaphore frozen;
+    app.setHandler(QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"), [&frozen](const QDBusMessage &call) {
+        frozen.tryAcquire(1, 10000);
+        return call.createReply(QVariant::fromValue(QDBusVariant(QStringLiteral("Busy"))));
+    });
+    r.setUnresponsiveThreshold(1);
+    respondingSpy.clear();
+    const AccessibleObject busy = app.object(r);
+    QVERIFY(busy.name().isEmpty());
+    QTRY_COMPARE(respondingSpy.count(), 1);
+    QCOMPARE(respondingSpy.at(0).at(1).toBool(), false);
+    // Probes time out after a second.
+    QTest::qWait(1500);
+    QCOMPARE(respondingSpy.count(), 1);
+    frozen.release();
+    QTRY_COMPARE(respondingSpy.count(), 2);
+    QCOMPARE(respondingSpy.at(1).at(1).toBool(), true);
+    QVERIFY(app.calls(QStringLiteral("GetRole")) > 0);
+}
+
+void AccessibilityClientTest::tst_serviceCallState()
+{
+    Registry r;
+    RegistryPrivateCacheApi cache(&r);
+
+    // The call state kept for an application leaves with it, a new owner
+    // of the name starts afresh.
+    const QString name = QStringLiteral("org.kde.qaccessibilityclient.ServiceCallState");
+    r.setDirectConnectionsEnabled(true);
+    r.setUnresponsiveThreshold(1);
+    r.setCallTimeout(QStringLiteral("org.a11y.atspi.Accessible.GetRole"), 200);
+    {
+        FakeApplication app;
+        QVERIFY(app.start());
+        QVERIFY(app.registerService(name));
+        // No address for a direct connection, an unsigned index and no reply at all.
+        app.setHandler(QLatin1String("org.a11y.atspi.Application"), QLatin1String("GetApplicationBusAddress"), [](const QDBusMessage &call) {
+            return call.createReply(QString());
+        });
+        app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetIndexInParent"), [](const QDBusMessage &call) {
+            return call.createReply(uint(1));
+        });
+        app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetRole"), [](const QDBusMessage &) {
+            return QDBusMessage();
+        });
+
+        const AccessibleObject accApp = app.object(r);
+        QCOMPARE(accApp.indexInParent(), 1);
+        QVERIFY(cache.signatureVariants().contains(name));
+        QCOMPARE(accApp.role(), AccessibleObject::NoRole);
+        QVERIFY(cache.trackedServices().contains(name));
+        QTRY_COMPARE(app.calls(QStringLiteral("GetApplicationBusAddress")), 1);
+    }
+    QTRY_VERIFY(!cache.trackedServices().contains(name));
+    QVERIFY(!cache.signatureVariants().contains(name));
+
+    {
+        FakeApplication app;
+        QVERIFY(app.start());
+        QVERIFY(app.registerService(name));
+        app.setHandler(QLatin1String("org.a11y.atspi.Application"), QLatin1String("GetApplicationBusAddress"), [](const QDBusMessage &call) {
+            return call.createReply(QString());
+        });
+        app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetIndexInParent"), [](const QDBusMessage &call) {
+            return call.createReply(2);
+        });
+        app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetRole"), [](const QDBusMessage &call) {
+            return call.createReply(uint(ATSPI_ROLE_FRAME));
+        });
+
+        // Not taken for the unresponsive previous owner, nor for a legacy toolkit.
+        const AccessibleObject accApp = app.object(r);
+        QVERIFY(!accApp.isDefunct());
+        QCOMPARE(accApp.role(), AccessibleObject::Frame);
+        QCOMPARE(app.calls(QStringLiteral("GetRole")), 1);
+        QCOMPARE(accApp.indexInParent(), 2);
+        QVERIFY(!cache.signatureVariants().contains(name));
+        // Asked again, the answer of the previous owner was dropped.
+        QTRY_COMPARE(app.calls(QStringLiteral("GetApplicationBusAddress")), 1);
+    }
+}
+
+void AccessibilityClientTest::tst_callDeadline()
+{
+    Registry r;
+    r.setUnresponsiveThreshold(0);
+
+    QVERIFY(startHelperProcess());
+
+    const AccessibleObject remoteApp = waitForHelperApp(r);
+    QVERIFY(remoteApp.isValid());
+    AccessibleObject window = remoteApp.child(0);
+    QVERIFY(window.isValid());
+
+    ::kill(helperProcess.processId(), SIGSTOP);
+
+    // Per method timeouts win over the default.
+    r.setCallTimeout(QString(), 2000);
+    r.setCallTimeout(QLatin1String("org.a11y.atspi.Accessible.GetRole"), 100);
+    QCOMPARE(r.callTimeout(QLatin1String("org.a11y.atspi.Accessible.GetRole")), 100);
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(window.role(), AccessibleObject::NoRole);
+    QVERIFY(timer.elapsed() < 1000);
+
+    // All calls together keep to the deadline.
+    r.setCallTimeout(QString(), -1);
+    r.setCallTimeout(QLatin1String("org.a11y.atspi.Accessible.GetRole"), -1);
+    QCOMPARE(r.callTimeout(), -1);
+    timer.restart();
+    {
+        CallDeadline deadline(r, 300);
+        QCOMPARE(window.role(), AccessibleObject::NoRole);
+        QVERIFY(window.name().isEmpty());
+        QVERIFY(window.children().isEmpty());
+        QVERIFY(deadline.hasExpired());
+    }
+    QVERIFY(timer.elapsed() < 1000);
+
+    ::kill(helperProcess.processId(), SIGCONT);
+    helperProcess.terminate();
+    QVERIFY(helperProcess.waitForFinished());
+}
+
+void AccessibilityClientTest::tst_directConnections()
+{
+    Registry r;
+    QVERIFY(!r.directConnectionsEnabled());
+
+    QVERIFY(startHelperProcess());
+
+    const AccessibleObject remoteApp = waitForHelperApp(r);
+    QVERIFY(remoteApp.isValid());
+    AccessibleObject window = remoteApp.child(0);
+    QVERIFY(window.isValid());
+    const QString name = window.name();
+    const AccessibleObject::Role role = window.role();
+
+    // Whether or not the application offers its own address, calls keep working.
+    r.setDirectConnectionsEnabled(true);
+    QVERIFY(r.directConnectionsEnabled());
+    QCOMPARE(window.name(), name);
+    QCOMPARE(window.role(), role);
+    QCOMPARE(remoteApp.child(0), window);
+
+    r.setDirectConnectionsEnabled(false);
+    QCOMPARE(window.name(), name);
+
+    helperProcess.terminate();
+    QVERIFY(helperProcess.waitForFinished());
+
+    // Until the address is known calls go through the bus, even if it never is.
+    FakeApplication app;
+    QVERIFY(app.start());
+    app.setHandler(QLatin1String("org.a11y.atspi.Application"), QLatin1String("GetApplicationBusAddress"), [](const QDBusMessage &) {
+        return QDBusMessage();
+    });
+    app.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetRole"), [](const QDBusMessage &call) {
+        return call.createReply(uint(ATSPI_ROLE_PUSH_BUTTON));
+    });
+    r.setDirectConnectionsEnabled(true);
+    const AccessibleObject button = app.object(r);
+    QElapsedTimer timer;
+    timer.start();
+    QFuture<AccessibleObject::Role> role = button.roleAsync();
+    QVERIFY(timer.elapsed() < 250);
+    QCOMPARE(button.role(), AccessibleObject::Button);
+    QVERIFY(timer.elapsed() < 250);
+    QTRY_VERIFY(role.isFinished());
+    QCOMPARE(role.result(), AccessibleObject::Button);
+    QCOMPARE(app.calls(QStringLiteral("GetApplicationBusAddress")), 1);
+}
+
+void AccessibilityClientTest::tst_connectionPool()
+{
+    Registry r;
+    QCOMPARE(r.connectionPoolSize(), 1);
+
+    QVERIFY(startHelperProcess());
+
+    const AccessibleObject remoteApp = waitForHelperApp(r);
+    QVERIFY(remoteApp.isValid());
+    AccessibleObject window = remoteApp.child(0);
+    QVERIFY(window.isValid());
+    const QString name = window.name();
+    const AccessibleObject::Role role = window.role();
+
+    // Whichever connection the application ends up on, calls keep working.
+    r.setConnectionPoolSize(4);
+    QCOMPARE(r.connectionPoolSize(), 4);
+    QCOMPARE(window.name(), name);
+    QCOMPARE(window.role(), role);
+    QCOMPARE(remoteApp.child(0), window);
+
+    r.setConnectionPoolSize(0);
+    QCOMPARE(r.connectionPoolSize(), 1);
+    QCOMPARE(window.name(), name);
+
+    // A service keeps its connection.
+    DBusConnection connection;
+    connection.setPoolSize(4);
+    QHash<QString, QString> connectionNames;
+    for (int i = 0; i < 8; ++i) {
+        const QString service = QStringLiteral(":1.%1").arg(i);
+        connectionNames.insert(service, connection.connection(service).name());
+        QCOMPARE(connection.connection(service).name(), connectionNames.value(service));
+    }
+    // Also when the pool grows, calls to it stay in order.
+    connection.setPoolSize(8);
+    for (auto it = connectionNames.constBegin(); it != connectionNames.constEnd(); ++it)
+        QCOMPARE(connection.connection(it.key()).name(), it.value());
+
+    helperProcess.terminate();
+    QVERIFY(helperProcess.waitForFinished());
+}
+
+void AccessibilityClientTest::tst_threads()
+{
+    Registry r;
+    r.subscribeEventListeners(Registry::Focus);
+
+    // Receives the events in a thread of its own.
+    QThread receiverThread;
+    ThreadRecorder recorder;
+    recorder.moveToThread(&receiverThread);
+    receiverThread.start();
+    connect(&r, &Registry::focusChanged, &recorder, &ThreadRecorder::focus);
+
+    QVERIFY(startHelperProcess());
+
+    const AccessibleObject remoteApp = waitForHelperApp(r);
+    QVERIFY(remoteApp.isValid());
+    const AccessibleObject window = remoteApp.child(0);
+    QVERIFY(window.isValid());
+    QStringList names;
+    const QList<AccessibleObject> children = window.children();
+    for (const AccessibleObject &child : children)
+        names.append(child.name());
+    QVERIFY(!names.isEmpty());
+
+    // The same objects walked from several threads at once.
+    QVector<QStringList> results(4);
+    QList<QThread*> walkers;
+    for (int i = 0; i < results.size(); ++i) {
+        QStringList *result = &results[i];
+        walkers.append(QThread::create([window, result]() {
+            for (int round = 0; round < 10; ++round) {
+                result->clear();
+                const QList<AccessibleObject> children = window.children();
+                for (const AccessibleObject &child : children)
+                    result->append(child.name());
+            }
+        }));
+        walkers.last()->start();
+    }
+    for (QThread *walker : std::as_const(walkers)) {
+        QVERIFY(walker->wait(30000));
+        delete walker;
+    }
+    for (const QStringList &result : std::as_const(results))
+        QCOMPARE(result, names);
+
+    // The focus events of the helper arrive in the thread of the receiver.
+    QTRY_VERIFY(!recorder.receivedIn().isEmpty());
+    const QList<QThread*> threads = recorder.receivedIn();
+    for (QThread *thread : threads)
+        QCOMPARE(thread, &receiverThread);
+
+    receiverThread.quit();
+    QVERIFY(receiverThread.wait());
+    helperProcess.terminate();
+    QVERIFY(helperProcess.waitForFinished());
+}
+
+static bool readStatus(const QString &property)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(QLatin1String("org.a11y.Bus"), QLatin1String("/org/a11y/bus"),
+            QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"));
+    message.setArguments(QVariantList() << QLatin1String("org.a11y.Status") << property);
+    const QDBusReply<QVariant> reply = QDBusConnection::sessionBus().call(message);
+    return reply.isValid() && reply.value().toBool();
+}
+
+void AccessibilityClientTest::tst_actions()
+{
+    FakeApplication app;
+    QVERIFY(app.start());
+    app.setHandler(QLatin1String("org.a11y.atspi.Action"), QLatin1String("GetActions"), [](const QDBusMessage &call) {
+        const QList<FakeAction> actions = { { QStringLiteral("press"), QStringLiteral("Presses the button"), QString() } };
+        return call.createReply(QVariant::fromValue(actions));
+    });
+    // Never answered, triggering an action must not wait for it.
+    app.setHandler(QLatin1String("org.a11y.atspi.Action"), QLatin1String("DoAction"), [](const QDBusMessage &) {
+        return QDBusMessage();
+    });
+
+    Registry r;
+    const AccessibleObject object = app.object(r);
+    const QVector<QSharedPointer<QAction> > actions = object.actions();
+    QCOMPARE(actions.size(), 1);
+    QCOMPARE(actions.at(0)->text(), QStringLiteral("press"));
+    QCOMPARE(actions.at(0)->whatsThis(), QStringLiteral("Presses the button"));
+    QCOMPARE(actions.at(0)->thread(), QThread::currentThread());
+    QVERIFY(!actions.at(0)->parent());
+
+    QElapsedTimer timer;
+    timer.start();
+    actions.at(0)->trigger();
+    QVERIFY(timer.elapsed() < 250);
+    QTRY_COMPARE(app.calls(QStringLiteral("DoAction")), 1);
+
+    // Other threads get actions of their own.
+    QThread *otherThread = nullptr;
+    QThread *actionThread = nullptr;
+    QThread *thread = QThread::create([object, &otherThread, &actionThread]() {
+        otherThread = QThread::currentThread();
+        const QVector<QSharedPointer<QAction> > otherActions = object.actions();
+        if (!otherActions.isEmpty())
+            actionThread = otherActions.at(0)->thread();
+    });
+    thread->start();
+    QVERIFY(thread->wait(30000));
+    delete thread;
+    QVERIFY(otherThread);
+    QCOMPARE(actionThread, otherThread);
+    QCOMPARE(object.actions(), actions);
+}
+
+void AccessibilityClientTest::tst_cachedStatus()
+{
+    Registry r;
+    QTRY_COMPARE(r.isEnabled(), readStatus(QLatin1String("IsEnabled")));
+    const bool screenReader = r.isScreenReaderEnabled();
+    QCOMPARE(screenReader, readStatus(QLatin1String("ScreenReaderEnabled")));
+    // The setting is shared with the whole session, put it back even if a check fails.
+    const auto restoreScreenReader = qScopeGuard([&r, screenReader]() {
+        r.setScreenReaderEnabled(screenReader);
+    });
+
+    // Changes made here are seen right away, the notification follows.
+    QSignalSpy spy(&r, SIGNAL(screenReaderEnabledChanged(bool)));
+    r.setScreenReaderEnabled(!screenReader);
+    QCOMPARE(r.isScreenReaderEnabled(), !screenReader);
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toBool(), !screenReader);
+
+    // Changes made by someone else arrive through the notification.
+    Registry other;
+    QCOMPARE(other.isScreenReaderEnabled(), !screenReader);
+    other.setScreenReaderEnabled(screenReader);
+    QTRY_COMPARE(r.isScreenReaderEnabled(), screenReader);
+    QCOMPARE(readStatus(QLatin1String("ScreenReaderEnabled")), screenReader);
+
+    // A change made while the status is still being read is not undone by the reply.
+    Registry early;
+    early.setScreenReaderEnabled(!screenReader);
+    QTest::qWait(200);
+    QCOMPARE(early.isScreenReaderEnabled(), !screenReader);
+}
 
 QTEST_MAIN(AccessibilityClientTest)
 
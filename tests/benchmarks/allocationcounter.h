@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// Include in one file per benchmark only, it replaces malloc for the whole executable.
+
+#include <cstdlib>
+
+#ifdef __GLIBC__
+// Counts heap allocations of this thread while enabled. QString and QList data go
+// straight to malloc, so operator new alone would miss most of them.
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static thread_local bool countAllocations = false;
+static thread_local int allocationCount = 0;
+
+extern "C" void *malloc(size_t size)
+{
+    if (countAllocations)
+        ++allocationCount;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    if (countAllocations)
+        ++allocationCount;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    if (countAllocations)
+        ++allocationCount;
+    return __libc_realloc(ptr, size);
+}
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QTest>
+#include <QDBusMessage>
+
+#include "qaccessibilityclient/calldescriptors_p.h"
+
+#include "allocationcounter.h"
+
+using namespace QAccessibleClient;
+
+static const QString service = QLatin1String(":1.42");
+static const QString path = QLatin1String("/org/a11y/atspi/accessible/42");
+
+// How the accessors in registry_p.cpp built their messages before CallDescriptors.
+static QDBusMessage literalMessage(bool property)
+{
+    if (property) {
+        QDBusMessage message = QDBusMessage::createMethodCall(service, path,
+                QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"));
+        message.setArguments(QVariantList() << QLatin1String("org.a11y.atspi.Accessible") << QLatin1String("Name"));
+        return message;
+    }
+    return QDBusMessage::createMethodCall(service, path, QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetRole"));
+}
+
+static QDBusMessage descriptorMessage(bool property)
+{
+    if (property) {
+        QDBusMessage message = CallDescriptors::methodCall(service, path, CallDescriptors::PropertiesGet);
+        message.setArguments(QVariantList() << CallDescriptors::name(CallDescriptors::AccessibleInterface)
+                                            << CallDescriptors::name(CallDescriptors::NameProperty));
+        return message;
+    }
+    return CallDescriptors::methodCall(service, path, CallDescriptors::GetRole);
+}
+
+class CallMessagesBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void allocations_data();
+    void allocations();
+    void buildMessage_data();
+    void buildMessage();
+};
+
+void CallMessagesBenchmark::initTestCase()
+{
+    // Creates the descriptor tables, which happens once per process.
+    descriptorMessage(true);
+    descriptorMessage(false);
+}
+
+static void addRows()
+{
+    QTest::addColumn<bool>("descriptors");
+    QTest::addColumn<bool>("property");
+    QTest::newRow("literals GetRole") << false << false;
+    QTest::newRow("descriptors GetRole") << true << false;
+    QTest::newRow("literals Properties.Get") << false << true;
+    QTest::newRow("descriptors Properties.Get") << true << true;
+}
+
+void CallMessagesBenchmark::allocations_data()
+{
+    addRows();
+}
+
+// Reports the heap allocations needed to build one message.
+void CallMessagesBenchmark::allocations()
+{
+#ifdef __GLIBC__
+    QFETCH(bool, descriptors);
+    QFETCH(bool, property);
+
+    allocationCount = 0;
+    countAllocations = true;
+    {
+        const QDBusMessage message = descriptors ? descriptorMessage(property) : literalMessage(property);
+        Q_UNUSED(message)
+    }
+    countAllocations = false;
+
+    QVERIFY(allocationCount > 0);
+    QTest::setBenchmarkResult(allocationCount, QTest::Events);
+#else
+    QSKIP("Counting allocations needs glibc.");
+#endif
+}
+
+void CallMessagesBenchmark::buildMessage_data()
+{
+    addRows();
+}
+
+void CallMessagesBenchmark::buildMessage()
+{
+    QFETCH(bool, descriptors);
+    QFETCH(bool, property);
+
+    QBENCHMARK {
+        const QDBusMessage message = descriptors ? descriptorMessage(property) : literalMessage(property);
+        Q_UNUSED(message)
+    }
+}
+
+QTEST_GUILESS_MAIN(CallMessagesBenchmark)
+
+#include "bench_callmessages.moc"
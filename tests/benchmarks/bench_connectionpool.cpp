@@ -0,0 +1,139 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QTest>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusReply>
+#include <QThread>
+
+#include "atspi/dbusconnection.h"
+
+using namespace QAccessibleClient;
+
+static const int maxWorkers = 8;
+static const int callsPerWorker = 200;
+
+// Stands in for an application, answers GetIndexInParent in a thread of its own.
+class ApplicationServer : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.a11y.atspi.Accessible")
+
+public Q_SLOTS:
+    int GetIndexInParent() const
+    {
+        return 0;
+    }
+};
+
+class ConnectionPoolBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parallelCalls_data();
+    void parallelCalls();
+
+private:
+    DBusConnection m_connection;
+    QList<QThread*> m_serverThreads;
+    QList<ApplicationServer*> m_servers;
+    QStringList m_services;
+};
+
+void ConnectionPoolBenchmark::initTestCase()
+{
+    // The applications connect to the bus the registry calls through.
+    QString address;
+    m_connection.connection();
+    if (m_connection.status() == DBusConnection::Connected) {
+        const QDBusMessage m = QDBusMessage::createMethodCall(QStringLiteral("org.a11y.Bus"), QStringLiteral("/org/a11y/bus"),
+                                                              QStringLiteral("org.a11y.Bus"), QStringLiteral("GetAddress"));
+        const QDBusReply<QString> reply = QDBusConnection::sessionBus().call(m);
+        if (reply.isValid())
+            address = reply.value();
+    }
+
+    for (int i = 0; i < maxWorkers; ++i) {
+        const QString name = QStringLiteral("bench_connectionpool-%1").arg(i);
+        QDBusConnection bus = address.isEmpty()
+                ? QDBusConnection::connectToBus(QDBusConnection::SessionBus, name)
+                : QDBusConnection::connectToBus(address, name);
+        if (!bus.isConnected())
+            QSKIP("Could not connect to the bus.");
+
+        QThread *thread = new QThread;
+        thread->start();
+        ApplicationServer *server = new ApplicationServer;
+        server->moveToThread(thread);
+        QVERIFY(bus.registerObject(QStringLiteral("/org/a11y/atspi/accessible/root"), server, QDBusConnection::ExportAllSlots));
+        m_serverThreads.append(thread);
+        m_servers.append(server);
+        m_services.append(bus.baseService());
+    }
+}
+
+void ConnectionPoolBenchmark::cleanupTestCase()
+{
+    for (int i = 0; i < m_servers.size(); ++i) {
+        QDBusConnection::disconnectFromBus(QStringLiteral("bench_connectionpool-%1").arg(i));
+        m_servers.at(i)->deleteLater();
+        m_serverThreads.at(i)->quit();
+        m_serverThreads.at(i)->wait();
+        delete m_serverThreads.at(i);
+    }
+}
+
+void ConnectionPoolBenchmark::parallelCalls_data()
+{
+    QTest::addColumn<int>("workers");
+    QTest::addColumn<int>("poolSize");
+
+    for (int workers = 1; workers <= maxWorkers; workers *= 2) {
+        QTest::addRow("%d workers, 1 connection", workers) << workers << 1;
+        if (workers > 1)
+            QTest::addRow("%d workers, %d connections", workers, workers) << workers << workers;
+    }
+}
+
+// Each worker makes blocking calls to an application of its own.
+void ConnectionPoolBenchmark::parallelCalls()
+{
+    QFETCH(int, workers);
+    QFETCH(int, poolSize);
+
+    m_connection.setPoolSize(poolSize);
+
+    QBENCHMARK {
+        QList<QThread*> threads;
+        for (int i = 0; i < workers; ++i) {
+            const QString service = m_services.at(i);
+            DBusConnection *connection = &m_connection;
+            threads.append(QThread::create([connection, service]() {
+                const QDBusMessage message = QDBusMessage::createMethodCall(service, QStringLiteral("/org/a11y/atspi/accessible/root"),
+                        QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetIndexInParent"));
+                const QDBusConnection bus = connection->connection(service);
+                for (int call = 0; call < callsPerWorker; ++call)
+                    bus.call(message);
+            }));
+            threads.last()->start();
+        }
+        for (QThread *thread : std::as_const(threads)) {
+            QVERIFY(thread->wait());
+            delete thread;
+        }
+    }
+
+    m_connection.setPoolSize(1);
+}
+
+QTEST_GUILESS_MAIN(ConnectionPoolBenchmark)
+
+#include "bench_connectionpool.moc"
@@ -0,0 +1,144 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QDBusConnection>
+#include <QDBusPendingCallWatcher>
+#include <QDBusReply>
+
+#include "atspi/qt-atspi.h"
+#include "qaccessibilityclient/objecthandles_p.h"
+
+using namespace QAccessibleClient;
+
+/**
+    Answers GetChildren with a long list of references, like a big table would.
+ */
+class ChildrenServer : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.a11y.atspi.Accessible")
+public:
+    QSpiObjectReferenceList children;
+
+public Q_SLOTS:
+    QAccessibleClient::QSpiObjectReferenceList GetChildren() const
+    {
+        return children;
+    }
+};
+
+class ObjectReferencesBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void decodeReferenceList_data();
+    void decodeReferenceList();
+    void decodeHandles_data();
+    void decodeHandles();
+
+private:
+    void fetchChildren(int count);
+
+    ChildrenServer m_server;
+    QDBusMessage m_reply;
+    int m_count = 0;
+};
+
+static const QLatin1String serverConnectionName("bench_objectreferences_server");
+
+void ObjectReferencesBenchmark::initTestCase()
+{
+    registerDBusTypes();
+    QDBusConnection server = QDBusConnection::connectToBus(QDBusConnection::SessionBus, serverConnectionName);
+    if (!server.isConnected())
+        QSKIP("No session bus available.");
+    QVERIFY(server.registerObject(QStringLiteral("/children"), &m_server, QDBusConnection::ExportAllSlots));
+}
+
+void ObjectReferencesBenchmark::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromBus(serverConnectionName);
+}
+
+void ObjectReferencesBenchmark::fetchChildren(int count)
+{
+    if (m_count == count)
+        return;
+
+    QDBusConnection server(serverConnectionName);
+    m_server.children.clear();
+    for (int i = 0; i < count; ++i) {
+        QSpiObjectReference reference;
+        reference.service = server.baseService();
+        reference.path = QDBusObjectPath(QStringLiteral("/org/a11y/atspi/accessible/%1").arg(i));
+        m_server.children.append(reference);
+    }
+
+    // The server lives in this thread, so wait for the reply with the event loop running.
+    const QDBusMessage message = QDBusMessage::createMethodCall(server.baseService(), QStringLiteral("/children"),
+            QStringLiteral("org.a11y.atspi.Accessible"), QStringLiteral("GetChildren"));
+    QDBusPendingCallWatcher watcher(QDBusConnection::sessionBus().asyncCall(message));
+    QSignalSpy finished(&watcher, &QDBusPendingCallWatcher::finished);
+    QVERIFY(finished.wait());
+    m_reply = watcher.reply();
+    QCOMPARE(m_reply.signature(), QStringLiteral("a(so)"));
+    m_count = count;
+}
+
+void ObjectReferencesBenchmark::decodeReferenceList_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10") << 10;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+// What RegistryPrivate::children() did before: QSpiObjectReferenceList first, then the handles.
+void ObjectReferencesBenchmark::decodeReferenceList()
+{
+    QFETCH(int, count);
+    fetchChildren(count);
+
+    ObjectHandles handles;
+    QVector<ObjectHandle> result;
+    QBENCHMARK {
+        result.clear();
+        QDBusReply<QSpiObjectReferenceList> reply(m_reply);
+        const QSpiObjectReferenceList children = reply.value();
+        for (const QSpiObjectReference &child : children)
+            result.append(handles.handle(child.service, child.path.path()));
+    }
+    QCOMPARE(result.size(), count);
+}
+
+void ObjectReferencesBenchmark::decodeHandles_data()
+{
+    decodeReferenceList_data();
+}
+
+void ObjectReferencesBenchmark::decodeHandles()
+{
+    QFETCH(int, count);
+    fetchChildren(count);
+
+    ObjectHandles handles;
+    QVector<ObjectHandle> result;
+    QBENCHMARK {
+        result = handles.handles(m_reply.arguments().at(0).value<QDBusArgument>());
+    }
+    QCOMPARE(result.size(), count);
+    QCOMPARE(handles.path(result.last()), m_server.children.last().path.path());
+}
+
+QTEST_GUILESS_MAIN(ObjectReferencesBenchmark)
+
+#include "bench_objectreferences.moc"
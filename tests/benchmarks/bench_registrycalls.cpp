@@ -0,0 +1,151 @@
+/*
+    SPDX-FileCopyrightText: 2012 Frederik Gladhorn <gladhorn@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+
+#include <QTest>
+#include <QDBusMessage>
+#include <QDBusVariant>
+#include <QScopeGuard>
+
+#include "qaccessibilityclient/registry.h"
+#include "qaccessibilityclient/registrycache_p.h"
+
+#include "atspi/atspi-constants.h"
+
+#include "fakeapplication.h"
+
+#include "allocationcounter.h"
+
+using namespace QAccessibleClient;
+
+// Timeouts for calls the benchmark does not make, looked up on every call all the same.
+static const char *const otherTimeouts[] = {
+    "org.a11y.atspi.Text",
+    "org.a11y.atspi.Component.GetExtents",
+    "org.a11y.atspi.Accessible.GetChildren",
+    "org.a11y.atspi.Action.DoAction",
+};
+
+/**
+    Measures one read-only call the way the accessors make it, that is
+    through sharing, the timeout lookup and the responsiveness check of
+    RegistryPrivate, answered by a fake application without cache.
+ */
+class RegistryCallsBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void allocations_data();
+    void allocations();
+    void call_data();
+    void call();
+
+private:
+    void setCallTimeouts(bool set);
+    void makeCall(bool property);
+
+    Registry m_registry;
+    FakeApplication m_application;
+    AccessibleObject m_object;
+};
+
+void RegistryCallsBenchmark::initTestCase()
+{
+    QVERIFY(m_application.start());
+    m_application.setHandler(QLatin1String("org.a11y.atspi.Accessible"), QLatin1String("GetRole"), [](const QDBusMessage &call) {
+        return call.createReply(uint(ATSPI_ROLE_PUSH_BUTTON));
+    });
+    m_application.setHandler(QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("Get"), [](const QDBusMessage &call) {
+        return call.createReply(QVariant::fromValue(QDBusVariant(QStringLiteral("OK"))));
+    });
+
+    // Every call goes to the application.
+    RegistryPrivateCacheApi(&m_registry).setCacheType(RegistryPrivateCacheApi::NoCache);
+    m_object = m_application.object(m_registry);
+    QCOMPARE(m_object.role(), AccessibleObject::Button);
+    QCOMPARE(m_object.name(), QStringLiteral("OK"));
+}
+
+void RegistryCallsBenchmark::cleanupTestCase()
+{
+    m_object = AccessibleObject();
+}
+
+void RegistryCallsBenchmark::setCallTimeouts(bool set)
+{
+    for (const char *name : otherTimeouts)
+        m_registry.setCallTimeout(QLatin1String(name), set ? 5000 : -1);
+    m_registry.setCallTimeout(QLatin1String("org.a11y.atspi.Accessible"), set ? 5000 : -1);
+}
+
+void RegistryCallsBenchmark::makeCall(bool property)
+{
+    if (property)
+        m_object.name();
+    else
+        m_object.role();
+}
+
+static void addRows()
+{
+    QTest::addColumn<bool>("property");
+    QTest::addColumn<bool>("timeouts");
+    QTest::newRow("GetRole") << false << false;
+    QTest::newRow("GetRole with call timeouts") << false << true;
+    QTest::newRow("Properties.Get") << true << false;
+    QTest::newRow("Properties.Get with call timeouts") << true << true;
+}
+
+void RegistryCallsBenchmark::allocations_data()
+{
+    addRows();
+}
+
+// Reports the heap allocations of the calling thread for one call, the bus
+// and the reply are shared by all rows.
+void RegistryCallsBenchmark::allocations()
+{
+#ifdef __GLIBC__
+    QFETCH(bool, property);
+    QFETCH(bool, timeouts);
+    setCallTimeouts(timeouts);
+    auto reset = qScopeGuard([this]() { setCallTimeouts(false); });
+
+    allocationCount = 0;
+    countAllocations = true;
+    makeCall(property);
+    countAllocations = false;
+
+    QVERIFY(allocationCount > 0);
+    QTest::setBenchmarkResult(allocationCount, QTest::Events);
+#else
+    QSKIP("Counting allocations needs glibc.");
+#endif
+}
+
+void RegistryCallsBenchmark::call_data()
+{
+    addRows();
+}
+
+void RegistryCallsBenchmark::call()
+{
+    QFETCH(bool, property);
+    QFETCH(bool, timeouts);
+    setCallTimeouts(timeouts);
+    auto reset = qScopeGuard([this]() { setCallTimeouts(false); });
+
+    QBENCHMARK {
+        makeCall(property);
+    }
+}
+
+QTEST_GUILESS_MAIN(RegistryCallsBenchmark)
+
+#include "bench_registrycalls.moc"